@@ -0,0 +1,220 @@
+/**
+* @file bench_libsokoban.c
+* @brief Banc d'essai du débit de libsokoban
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* N'utilise que libsokoban.h, comme un programme qui embarque le moteur.
+* Chaque fil d'exécution clone la partie du niveau et y joue des coups
+* tirés au hasard (un sur huit est une annulation), en demandant après
+* chaque coup si la partie est gagnée. La partie est sérialisée puis
+* reclonée tous les CLONE_COUPS coups, pour que l'arbre des variantes ne
+* grossisse pas sans fin. Chaque mesure est une ligne JSON sur la sortie
+* standard.
+*
+*/
+
+/* Fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "libsokoban.h"
+
+/* Définition de constante*/
+#define DUREE_DEFAUT 0.5
+#define CLONE_COUPS 65536
+#define FILS_MAX 256
+
+/* Définition de type*/
+/**
+* @brief Travail d'un fil d'exécution
+*/
+typedef struct {
+    t_sokoban *modele;      // partie clonée par le fil, jamais jouée
+    double duree;
+    uint32_t graine;
+    long coups;             // coups demandés, annulations comprises
+    long clones;
+    long gagnees;
+    size_t octets;          // octets sérialisés
+    int erreur;
+} t_fil_bench;
+
+/* Définition de fonction*/
+double horloge();
+void *fil_bench(void *arg);
+void mesurer_debit(char fichier[], t_sokoban *modele, int nbFils,
+    double duree);
+
+
+/**
+* @brief Entrée du banc d'essai
+* @return 0 : arrêt normal du programme, 1 si un niveau est illisible
+* bench_libsokoban [--duree s] [--threads N] [niveau.sok ...]
+* Sans niveau, mesure niveau1.sok à niveau6.sok. Le débit est mesuré sur
+* un fil puis sur N fils (par défaut, un par processeur).
+*/
+int main(int argc, char *argv[]) {
+    double duree = DUREE_DEFAUT;
+    char *niveaux[64];
+    int nbNiveaux = 0;
+    int nbFils = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int res = 0;
+
+    for (int a = 1; a < argc; a++) {
+        if ( strcmp(argv[a], "--duree") == 0 && a + 1 < argc ) {
+            duree = atof(argv[++a]);
+        } else if ( strcmp(argv[a], "--threads") == 0 && a + 1 < argc ) {
+            nbFils = atoi(argv[++a]);
+        } else if ( nbNiveaux < 64 ) {
+            niveaux[nbNiveaux++] = argv[a];
+        }
+    }
+    if ( nbFils < 1 ) {
+        nbFils = 1;
+    }
+    if ( nbFils > FILS_MAX ) {
+        nbFils = FILS_MAX;
+    }
+    if ( nbNiveaux == 0 ) {
+        static char noms[6][24];
+        for (int k = 0; k < 6; k++) {
+            snprintf(noms[k], sizeof(noms[k]), "niveau%d.sok", k + 1);
+            niveaux[nbNiveaux++] = noms[k];
+        }
+    }
+
+    for (int k = 0; k < nbNiveaux; k++) {
+        int erreur;
+        t_sokoban *modele = sokoban_ouvrir(niveaux[k], &erreur);
+        if ( modele == NULL ) {
+            fprintf(stderr, "niveau illisible : %s (%d)\n", niveaux[k], erreur);
+            res = 1;
+            continue;
+        }
+        mesurer_debit(niveaux[k], modele, 1, duree);
+        if ( nbFils > 1 ) {
+            mesurer_debit(niveaux[k], modele, nbFils, duree);
+        }
+        sokoban_liberer(modele);
+    }
+    return res;
+}
+
+
+/**
+* @brief Donne l'heure d'une horloge monotone
+* @return le temps en secondes
+*/
+double horloge() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+
+/**
+* @brief Joue des coups au hasard sur des clones du modèle pendant la
+* durée demandée
+* @param arg de type *t_fil_bench : le travail du fil
+* @return NULL
+*/
+void *fil_bench(void *arg) {
+    t_fil_bench *fil = arg;
+    uint32_t graine = fil->graine;
+    double fin = horloge() + fil->duree;
+    uint8_t *tampon = NULL;
+    size_t capacite = 0;
+
+    while ( horloge() < fin && fil->erreur == SOKOBAN_OK ) {
+        t_sokoban *partie = sokoban_cloner(fil->modele, &fil->erreur);
+        size_t taille;
+
+        if ( partie == NULL ) {
+            break;
+        }
+        fil->clones++;
+        for (long k = 0; k < CLONE_COUPS; k++) {
+            graine ^= graine << 13;
+            graine ^= graine >> 17;
+            graine ^= graine << 5;
+            if ( (graine & 7) == 7 ) {
+                sokoban_annuler(partie);
+            } else if ( sokoban_jouer(partie, (int)(graine & 3)) ==
+                SOKOBAN_ERREUR_MEMOIRE ) {
+                fil->erreur = SOKOBAN_ERREUR_MEMOIRE;
+                break;
+            }
+            fil->gagnees += sokoban_gagne(partie);
+        }
+        fil->coups += CLONE_COUPS;
+
+        taille = sokoban_serialiser(partie, NULL, 0);
+        if ( taille > capacite ) {
+            uint8_t *nouveau = realloc(tampon, taille);
+            if ( nouveau == NULL ) {
+                fil->erreur = SOKOBAN_ERREUR_MEMOIRE;
+                sokoban_liberer(partie);
+                break;
+            }
+            tampon = nouveau;
+            capacite = taille;
+        }
+        fil->octets += sokoban_serialiser(partie, tampon, capacite);
+        sokoban_liberer(partie);
+    }
+    free(tampon);
+    return NULL;
+}
+
+
+/**
+* @brief Mesure le débit de nbFils fils qui jouent chacun leur partie et
+* affiche le résultat sur une ligne JSON
+* @param fichier de type char : le nom du niveau
+* @param modele de type *t_sokoban : la partie du niveau
+* @param nbFils de type int : le nombre de fils d'exécution
+* @param duree de type double : la durée de la mesure en secondes
+*/
+void mesurer_debit(char fichier[], t_sokoban *modele, int nbFils,
+    double duree) {
+    static t_fil_bench fils[FILS_MAX];
+    pthread_t threads[FILS_MAX];
+    long coups = 0, clones = 0, gagnees = 0;
+    size_t octets = 0;
+    int erreur = SOKOBAN_OK;
+    double debut, temps;
+
+    debut = horloge();
+    for (int f = 0; f < nbFils; f++) {
+        memset(&fils[f], 0, sizeof(fils[f]));
+        fils[f].modele = modele;
+        fils[f].duree = duree;
+        fils[f].graine = 2463534242u + 7919u * (uint32_t)f;
+        pthread_create(&threads[f], NULL, fil_bench, &fils[f]);
+    }
+    for (int f = 0; f < nbFils; f++) {
+        pthread_join(threads[f], NULL);
+        coups += fils[f].coups;
+        clones += fils[f].clones;
+        gagnees += fils[f].gagnees;
+        octets += fils[f].octets;
+        if ( fils[f].erreur != SOKOBAN_OK ) {
+            erreur = fils[f].erreur;
+        }
+    }
+    temps = horloge() - debut;
+
+    printf("{\"bench\":\"libsokoban\",\"niveau\":\"%s\",\"fils\":%d,"
+        "\"coups\":%ld,\"coups_s\":%.0f,\"coups_s_fil\":%.0f,"
+        "\"ns_coup\":%.2f,\"clones\":%ld,\"gagnees\":%ld,"
+        "\"octets_serialises\":%zu,\"erreur\":%d}\n",
+        fichier, nbFils, coups, (double)coups / temps,
+        (double)coups / temps / nbFils, temps * 1e9 * nbFils / (double)coups,
+        clones, gagnees, octets, erreur);
+    fflush(stdout);
+}
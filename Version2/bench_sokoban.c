@@ -0,0 +1,405 @@
+/**
+* @file bench_sokoban.c
+* @brief Banc d'essai des fonctions du jeu Sokoban
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* Mesure deplacer(), undo(), gagne(), afficher_plateau(), charger_partie()
+* et cherche_joueur() sur des niveaux .sok et sur de grands plateaux
+* générés. Chaque mesure est une ligne JSON sur la sortie standard :
+* nanosecondes par appel (meilleure et médiane des répétitions),
+* allocations et octets alloués par appel, octets écrits par appel.
+* Les allocations sont comptées en enveloppant malloc(), calloc() et
+* realloc() à l'édition de liens (voir le Makefile).
+*
+*/
+
+/* Fichiers inclus */
+#include "sokoban.h"
+
+/* Définition de constante*/
+#define REPETITIONS 5
+#define DUREE_DEFAUT 0.05
+#define DIRECTIONS_TIRAGE 4096
+#define SYNTHESE_MURS 8        // pourcentage de murs intérieurs
+#define SYNTHESE_CAISSES 4     // pourcentage de caisses (autant de cibles)
+
+/* Définition de type*/
+/**
+* @brief Fonction mesurée : fait n appels et renvoie les octets écrits
+*/
+typedef long (*t_mesure)(long n);
+
+/**
+* @brief État partagé par les mesures d'un même niveau
+*/
+typedef struct {
+    char *fichier;
+    char *nom;          // nom du niveau dans les résultats
+    t_plateau depart;
+    t_plateau plat;
+    int joueur;
+    t_tab_deplacement depl;
+    t_sokoban *partie;  // le niveau de départ, pour afficher_plateau()
+    t_trame trame;
+    char touches[DIRECTIONS_TIRAGE];
+} t_banc;
+
+/* Définition de fonction*/
+void *__real_malloc(size_t taille);
+void *__real_calloc(size_t nb, size_t taille);
+void *__real_realloc(void *p, size_t taille);
+void *__wrap_malloc(size_t taille);
+void *__wrap_calloc(size_t nb, size_t taille);
+void *__wrap_realloc(void *p, size_t taille);
+double horloge();
+void banc_preparer(char fichier[]);
+void banc_liberer();
+long mesure_deplacer(long n);
+long mesure_undo(long n);
+long mesure_gagne(long n);
+long mesure_afficher_plateau(long n);
+long mesure_charger_partie(long n);
+long mesure_cherche_joueur(long n);
+void mesurer(const char *nom, t_mesure mesure, double dureeMin);
+char *generer_plateau(int largeur, int hauteur);
+
+static long allocations = 0;
+static long octetsAlloues = 0;
+static t_banc banc;
+
+
+/**
+* @brief Entrée du banc d'essai
+* @return 0 : arrêt normal du programme
+* bench_sokoban [--duree s] [--synthese LxH ...] [niveau.sok ...]
+* Sans niveau ni --synthese, mesure niveau1.sok à niveau6.sok et des
+* plateaux générés de 100x100 et 1000x1000. --duree fixe la durée
+* minimale d'une répétition (0,05 s par défaut).
+*/
+int main(int argc, char *argv[]) {
+    double duree = DUREE_DEFAUT;
+    char *niveaux[64];
+    int nbNiveaux = 0;
+    int tailles[32][2];
+    int nbTailles = 0;
+
+    for (int a = 1; a < argc; a++) {
+        if ( strcmp(argv[a], "--duree") == 0 && a + 1 < argc ) {
+            duree = atof(argv[++a]);
+        } else if ( strcmp(argv[a], "--synthese") == 0 && a + 1 < argc ) {
+            if ( nbTailles < 32 && sscanf(argv[++a], "%dx%d",
+                &tailles[nbTailles][0], &tailles[nbTailles][1]) == 2 ) {
+                nbTailles++;
+            }
+        } else if ( nbNiveaux < 64 ) {
+            niveaux[nbNiveaux++] = argv[a];
+        }
+    }
+    if ( nbNiveaux == 0 && nbTailles == 0 ) {
+        static char noms[6][24];
+        for (int k = 0; k < 6; k++) {
+            snprintf(noms[k], sizeof(noms[k]), "niveau%d.sok", k + 1);
+            niveaux[nbNiveaux++] = noms[k];
+        }
+        tailles[0][0] = tailles[0][1] = 100;
+        tailles[1][0] = tailles[1][1] = 1000;
+        nbTailles = 2;
+    }
+
+    for (int k = 0; k < nbNiveaux + nbTailles; k++) {
+        char nom[32];
+        char *fichier = (k < nbNiveaux) ? niveaux[k]
+            : generer_plateau(tailles[k - nbNiveaux][0], tailles[k - nbNiveaux][1]);
+        if ( access(fichier, R_OK) != 0 ) {
+            fprintf(stderr, "niveau illisible : %s\n", fichier);
+            continue;
+        }
+        banc_preparer(fichier);
+        if ( k >= nbNiveaux ) {
+            snprintf(nom, sizeof(nom), "synthese-%dx%d",
+                tailles[k - nbNiveaux][0], tailles[k - nbNiveaux][1]);
+            banc.nom = nom;
+        }
+        mesurer("deplacer", mesure_deplacer, duree);
+        mesurer("undo", mesure_undo, duree);
+        mesurer("gagne", mesure_gagne, duree);
+        mesurer("afficher_plateau", mesure_afficher_plateau, duree);
+        mesurer("charger_partie", mesure_charger_partie, duree);
+        mesurer("cherche_joueur", mesure_cherche_joueur, duree);
+        banc_liberer();
+        if ( k >= nbNiveaux ) {
+            unlink(fichier);
+            free(fichier);
+        }
+    }
+    return 0;
+}
+
+
+/**
+* @brief Enveloppes des fonctions d'allocation : comptent les appels et
+* les octets demandés, puis appellent la fonction de la libc
+*/
+void *__wrap_malloc(size_t taille) {
+    allocations++;
+    octetsAlloues += (long)taille;
+    return __real_malloc(taille);
+}
+
+
+void *__wrap_calloc(size_t nb, size_t taille) {
+    allocations++;
+    octetsAlloues += (long)(nb * taille);
+    return __real_calloc(nb, taille);
+}
+
+
+void *__wrap_realloc(void *p, size_t taille) {
+    allocations++;
+    octetsAlloues += (long)taille;
+    return __real_realloc(p, taille);
+}
+
+
+/**
+* @brief Donne l'heure d'une horloge monotone
+* @return le temps en secondes
+*/
+double horloge() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+
+/**
+* @brief Charge un niveau dans le banc et tire une suite fixe de touches,
+* pour que deux exécutions mesurent les mêmes coups
+* @param fichier de type char : le niveau .sok
+*/
+void banc_preparer(char fichier[]) {
+    static const char directions[4] = {HAUT, BAS, GAUCHE, DROITE};
+    uint32_t graine = 2463534242u;
+    int erreur;
+
+    banc.fichier = fichier;
+    banc.nom = fichier;
+    banc.depart.cases = NULL;
+    banc.plat.cases = NULL;
+    if (!charger_partie(&banc.depart, fichier, &banc.joueur)) {
+        exit(EXIT_FAILURE);
+    }
+    verifier_memoire(plateau_copier(&banc.plat, &banc.depart));
+    banc.partie = partie_creer(&banc.depart, &erreur);
+    verifier_memoire(banc.partie != NULL);
+    depl_init(&banc.depl);
+    trame_init(&banc.trame);
+    for (int k = 0; k < DIRECTIONS_TIRAGE; k++) {
+        graine ^= graine << 13;
+        graine ^= graine >> 17;
+        graine ^= graine << 5;
+        banc.touches[k] = directions[graine & 3];
+    }
+}
+
+
+/**
+* @brief Libère le niveau du banc
+*/
+void banc_liberer() {
+    plateau_liberer(&banc.depart);
+    plateau_liberer(&banc.plat);
+    depl_liberer(&banc.depl);
+    sokoban_liberer(banc.partie);
+    trame_liberer(&banc.trame);
+}
+
+
+/**
+* @brief Remet le plateau du banc au début de la partie
+*/
+static void banc_recommencer() {
+    verifier_memoire(plateau_copier(&banc.plat, &banc.depart));
+    cherche_joueur(&banc.plat, &banc.joueur);
+    depl_vider(&banc.depl);
+}
+
+
+long mesure_deplacer(long n) {
+    t_modifs modifs;
+    for (long k = 0; k < n; k++) {
+        modifs.n = 0;
+        deplacer(&banc.plat, &banc.depl, banc.touches[k % DIRECTIONS_TIRAGE],
+            &banc.joueur, &modifs);
+    }
+    return 0;
+}
+
+
+long mesure_undo(long n) {
+    t_modifs modifs;
+    for (long k = 0; k < n; k++) {
+        modifs.n = 0;
+        undo(&banc.plat, &banc.depl, &banc.joueur, &modifs);
+    }
+    return 0;
+}
+
+
+long mesure_gagne(long n) {
+    volatile bool fin = false;
+    for (long k = 0; k < n; k++) {
+        fin = gagne(&banc.plat);
+    }
+    (void)fin;
+    return 0;
+}
+
+
+long mesure_afficher_plateau(long n) {
+    long octets = 0;
+    for (long k = 0; k < n; k++) {
+        trame_commencer(&banc.trame);
+        afficher_plateau(&banc.trame, banc.partie, 1);
+        octets += (long)banc.trame.taille;
+    }
+    return octets;
+}
+
+
+long mesure_charger_partie(long n) {
+    for (long k = 0; k < n; k++) {
+        charger_partie(&banc.plat, banc.fichier, NULL);
+    }
+    return 0;
+}
+
+
+long mesure_cherche_joueur(long n) {
+    for (long k = 0; k < n; k++) {
+        cherche_joueur(&banc.plat, &banc.joueur);
+    }
+    return 0;
+}
+
+
+static int comparer_durees(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+
+/**
+* @brief Mesure une fonction et écrit le résultat en JSON.
+* Le nombre d'appels est doublé jusqu'à ce qu'une répétition dure au
+* moins dureeMin, puis REPETITIONS répétitions sont chronométrées, chacune
+* depuis le début de la partie. undo() est mesuré sur les coups joués
+* juste avant par deplacer().
+* @param nom de type char : le nom de la fonction mesurée
+* @param mesure de type t_mesure : la boucle d'appels
+* @param dureeMin de type double : la durée minimale d'une répétition
+*/
+void mesurer(const char *nom, t_mesure mesure, double dureeMin) {
+    bool annulation = (mesure == mesure_undo);
+    double durees[REPETITIONS];
+    long appels = 1, total = 0, octets = 0;
+    long allocs = 0, alloues = 0;
+
+    // étalonnage
+    for (;;) {
+        double debut;
+        banc_recommencer();
+        if ( annulation ) {
+            mesure_deplacer(appels);
+        }
+        debut = horloge();
+        mesure(appels);
+        if ( horloge() - debut >= dureeMin || appels >= (1L << 40) ) {
+            break;
+        }
+        appels *= 2;
+    }
+
+    for (int r = 0; r < REPETITIONS; r++) {
+        double debut;
+        long nb = appels;
+        long allocationsAvant, octetsAvant;
+        banc_recommencer();
+        if ( annulation ) {
+            mesure_deplacer(appels);
+            nb = banc.depl.nb;
+        }
+        allocationsAvant = allocations;
+        octetsAvant = octetsAlloues;
+        debut = horloge();
+        octets += mesure(nb);
+        durees[r] = (nb > 0) ? (horloge() - debut) * 1e9 / (double)nb : 0.0;
+        allocs += allocations - allocationsAvant;
+        alloues += octetsAlloues - octetsAvant;
+        total += nb;
+    }
+    qsort(durees, REPETITIONS, sizeof(double), comparer_durees);
+    if ( total == 0 ) {
+        total = 1;
+    }
+    printf("{\"bench\":\"%s\",\"niveau\":\"%s\",\"cases\":%ld,\"appels\":%ld,"
+        "\"ns_op\":%.2f,\"ns_op_mediane\":%.2f,\"allocs_op\":%.4f,"
+        "\"octets_alloues_op\":%.2f,\"octets_ecrits_op\":%.2f}\n",
+        nom, banc.nom, (long)banc.depart.largeur * banc.depart.hauteur,
+        total / REPETITIONS, durees[0], durees[REPETITIONS / 2],
+        (double)allocs / (double)total, (double)alloues / (double)total,
+        (double)octets / (double)total);
+    fflush(stdout);
+}
+
+
+/**
+* @brief Écrit dans un fichier temporaire un niveau généré : des murs au
+* bord et quelques murs, caisses et cibles placés au hasard (toujours le
+* même tirage), le joueur au centre
+* @param largeur de type int : nombre de colonnes
+* @param hauteur de type int : nombre de lignes
+* @return le nom du fichier (à libérer), ou NULL en cas d'erreur
+*/
+char *generer_plateau(int largeur, int hauteur) {
+    char *nom = strdup("/tmp/bench_sokoban_XXXXXX");
+    char *ligne = malloc((size_t)largeur + 1);
+    uint32_t graine = 88172645u;
+    int fd;
+    FILE *f;
+
+    if ( nom == NULL || ligne == NULL || (fd = mkstemp(nom)) < 0 ) {
+        printf("ERREUR SUR FICHIER");
+        exit(EXIT_FAILURE);
+    }
+    f = fdopen(fd, "w");
+    for (int i = 0; i < hauteur; i++) {
+        for (int j = 0; j < largeur; j++) {
+            uint32_t tirage;
+            graine ^= graine << 13;
+            graine ^= graine >> 17;
+            graine ^= graine << 5;
+            tirage = graine % 100;
+            if ( i == 0 || j == 0 || i == hauteur - 1 || j == largeur - 1
+                || tirage < SYNTHESE_MURS ) {
+                ligne[j] = MUR;
+            } else if ( tirage < SYNTHESE_MURS + SYNTHESE_CAISSES ) {
+                ligne[j] = CAISSE;
+            } else if ( tirage < SYNTHESE_MURS + 2 * SYNTHESE_CAISSES ) {
+                ligne[j] = CIBLE;
+            } else {
+                ligne[j] = VIDE;
+            }
+        }
+        if ( i == hauteur / 2 ) {
+            ligne[largeur / 2] = SOKOBAN;
+        }
+        ligne[largeur] = '\n';
+        fwrite(ligne, 1, (size_t)largeur + 1, f);
+    }
+    fclose(f);
+    free(ligne);
+    return nom;
+}
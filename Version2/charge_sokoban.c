@@ -0,0 +1,343 @@
+/**
+* @file charge_sokoban.c
+* @brief Générateur de charge pour serveur_sokoban
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* Ouvre un grand nombre de sessions sur la socket du serveur et leur fait
+* jouer des commandes à un débit total fixé : à chaque instant, le nombre
+* de commandes envoyées suit le débit demandé, en passant d'une session à
+* la suivante. Une session attend la réponse à sa commande avant d'en
+* envoyer une autre ; une commande qui ne peut pas partir à l'heure parce
+* que sa session attend encore est comptée en retard. La latence est
+* mesurée de l'envoi de la commande à la fin de sa réponse.
+*
+*/
+
+/* Fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+
+/* Définition de constante*/
+#define SESSIONS_DEFAUT 10000
+#define DEBIT_DEFAUT 20000
+#define DUREE_DEFAUT 5.0
+#define EVENEMENTS_MAX 256
+#define REPONSE_MAX 4096
+#define ETAT_TOUS 64            // une demande d'état toutes les 64 commandes
+
+/* Définition de type*/
+/**
+* @brief Une session du générateur
+*/
+typedef struct {
+    int fd;
+    bool attend;                // une commande est partie sans réponse
+    uint64_t envoi;             // heure d'envoi de la commande en cours
+    int lignesAttendues;        // lignes de réponse restant à lire
+    size_t nbRecu;
+    char recu[REPONSE_MAX];
+} t_session_charge;
+
+/**
+* @brief Latences mesurées, en nanosecondes
+*/
+typedef struct {
+    uint64_t *valeurs;
+    size_t nb;
+    size_t capa;
+} t_latences;
+
+/* Définition de fonction*/
+uint64_t horloge_ns();
+int connecter(char chemin[]);
+bool envoyer(t_session_charge *session, uint32_t *graine, long numero);
+bool recevoir(t_session_charge *session, t_latences *latences);
+void latences_ajouter(t_latences *latences, uint64_t valeur);
+int comparer(const void *a, const void *b);
+double quantile_us(t_latences *latences, double q);
+
+
+/**
+* @brief Entrée du générateur de charge
+* @return 0 : arrêt normal du programme, 1 en cas d'erreur
+* charge_sokoban <socket> [--sessions N] [--debit commandes/s] [--duree s]
+* Affiche une ligne JSON : commandes traitées, débit obtenu, commandes en
+* retard, latences médiane, p99, p99,9 et maximale en microsecondes.
+*/
+int main(int argc, char *argv[]) {
+    long nbSessions = SESSIONS_DEFAUT;
+    double debit = DEBIT_DEFAUT;
+    double duree = DUREE_DEFAUT;
+    struct epoll_event evenements[EVENEMENTS_MAX];
+    struct rlimit limite;
+    t_session_charge *sessions;
+    t_latences latences = { NULL, 0, 0 };
+    uint32_t graine = 2463534242u;
+    long envoyees = 0, retards = 0, erreurs = 0, suivante = 0;
+    uint64_t debut, fin, maintenant;
+    int ep;
+
+    if ( argc < 2 ) {
+        fprintf(stderr, "usage : %s <socket> [--sessions N] [--debit n/s] "
+            "[--duree s]\n", argv[0]);
+        return 1;
+    }
+    for (int a = 2; a < argc; a++) {
+        if ( strcmp(argv[a], "--sessions") == 0 && a + 1 < argc ) {
+            nbSessions = atol(argv[++a]);
+        } else if ( strcmp(argv[a], "--debit") == 0 && a + 1 < argc ) {
+            debit = atof(argv[++a]);
+        } else if ( strcmp(argv[a], "--duree") == 0 && a + 1 < argc ) {
+            duree = atof(argv[++a]);
+        }
+    }
+    if ( getrlimit(RLIMIT_NOFILE, &limite) == 0 ) {
+        limite.rlim_cur = limite.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limite);
+    }
+    sessions = calloc((size_t)nbSessions, sizeof(t_session_charge));
+    ep = epoll_create1(0);
+    if ( sessions == NULL || ep < 0 ) {
+        perror("charge_sokoban");
+        return 1;
+    }
+    for (long k = 0; k < nbSessions; k++) {
+        struct epoll_event ev;
+        sessions[k].fd = connecter(argv[1]);
+        if ( sessions[k].fd < 0 ) {
+            fprintf(stderr, "connexion %ld : %s\n", k, strerror(errno));
+            return 1;
+        }
+        ev.events = EPOLLIN;
+        ev.data.u64 = (uint64_t)k;
+        epoll_ctl(ep, EPOLL_CTL_ADD, sessions[k].fd, &ev);
+    }
+
+    debut = horloge_ns();
+    fin = debut + (uint64_t)(duree * 1e9);
+    while ( (maintenant = horloge_ns()) < fin ) {
+        // commandes dues depuis le début au débit demandé
+        long dues = (long)((double)(maintenant - debut) * 1e-9 * debit);
+        int nb;
+
+        for (long tour = 0; envoyees + retards < dues && tour < nbSessions; tour++) {
+            t_session_charge *session = &sessions[suivante];
+            suivante = (suivante + 1) % nbSessions;
+            if ( session->attend ) {
+                retards++;
+            } else if ( envoyer(session, &graine, envoyees) ) {
+                envoyees++;
+            } else {
+                erreurs++;
+                retards++;
+            }
+        }
+        nb = epoll_wait(ep, evenements, EVENEMENTS_MAX, 1);
+        for (int k = 0; k < nb; k++) {
+            if ( !recevoir(&sessions[evenements[k].data.u64], &latences) ) {
+                erreurs++;
+            }
+        }
+    }
+    // les dernières réponses
+    fin = horloge_ns() + 1000000000ull;
+    for (long k = 0; k < nbSessions && horloge_ns() < fin; k++) {
+        while ( sessions[k].attend && horloge_ns() < fin ) {
+            int nb = epoll_wait(ep, evenements, EVENEMENTS_MAX, 10);
+            for (int e = 0; e < nb; e++) {
+                recevoir(&sessions[evenements[e].data.u64], &latences);
+            }
+        }
+    }
+    maintenant = horloge_ns();
+
+    qsort(latences.valeurs, latences.nb, sizeof(uint64_t), comparer);
+    printf("{\"charge\":\"sokoban\",\"sessions\":%ld,\"debit_vise\":%.0f,"
+        "\"commandes\":%zu,\"commandes_s\":%.0f,\"en_retard\":%ld,"
+        "\"erreurs\":%ld,\"p50_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,"
+        "\"max_us\":%.1f}\n",
+        nbSessions, debit, latences.nb,
+        (double)latences.nb / ((double)(maintenant - debut) * 1e-9), retards,
+        erreurs, quantile_us(&latences, 0.5), quantile_us(&latences, 0.99),
+        quantile_us(&latences, 0.999), quantile_us(&latences, 1.0));
+
+    for (long k = 0; k < nbSessions; k++) {
+        close(sessions[k].fd);
+    }
+    close(ep);
+    free(sessions);
+    free(latences.valeurs);
+    return 0;
+}
+
+
+/**
+* @brief Donne l'heure d'une horloge monotone
+* @return le temps en nanosecondes
+*/
+uint64_t horloge_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+
+/**
+* @brief Ouvre une connexion non bloquante sur la socket du serveur
+* @param chemin de type char[] : le chemin de la socket
+* @return le descripteur, -1 en cas d'erreur
+*/
+int connecter(char chemin[]) {
+    struct sockaddr_un adresse;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if ( fd < 0 ) {
+        return -1;
+    }
+    memset(&adresse, 0, sizeof(adresse));
+    adresse.sun_family = AF_UNIX;
+    strncpy(adresse.sun_path, chemin, sizeof(adresse.sun_path) - 1);
+    // la connexion est bloquante : la file d'attente du serveur se vide
+    if ( connect(fd, (struct sockaddr *)&adresse, sizeof(adresse)) != 0 ) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+
+/**
+* @brief Envoie une commande tirée au hasard : un déplacement, parfois une
+* annulation, et une demande d'état toutes les ETAT_TOUS commandes
+* @param session de type *t_session_charge : la session
+* @param graine de type *uint32_t : l'état du générateur
+* @param numero de type long : le numéro de la commande
+* @return false si l'envoi a échoué
+*/
+bool envoyer(t_session_charge *session, uint32_t *graine, long numero) {
+    static const char commandes[8] = {'z', 's', 'q', 'd', 'z', 's', 'q', 'u'};
+    char ligne[2];
+
+    *graine ^= *graine << 13;
+    *graine ^= *graine >> 17;
+    *graine ^= *graine << 5;
+    ligne[0] = (numero % ETAT_TOUS == 0) ? 'e' : commandes[*graine & 7];
+    ligne[1] = '\n';
+    session->envoi = horloge_ns();
+    // la réponse à 'e' annonce elle-même ses lignes
+    session->lignesAttendues = (ligne[0] == 'e') ? -1 : 1;
+    if ( write(session->fd, ligne, 2) != 2 ) {
+        return false;
+    }
+    session->attend = true;
+    return true;
+}
+
+
+/**
+* @brief Lit la réponse d'une session ; quand elle est complète, note la
+* latence
+* @param session de type *t_session_charge : la session
+* @param latences de type *t_latences : les latences mesurées
+* @return false si la connexion est en erreur
+*/
+bool recevoir(t_session_charge *session, t_latences *latences) {
+    for (;;) {
+        ssize_t lu = read(session->fd, session->recu + session->nbRecu,
+            REPONSE_MAX - session->nbRecu);
+        size_t debut = 0;
+
+        if ( lu == 0 ) {
+            return false;
+        }
+        if ( lu < 0 ) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        session->nbRecu += (size_t)lu;
+        for (size_t k = 0; k < session->nbRecu && session->attend; k++) {
+            if ( session->recu[k] != '\n' ) {
+                continue;
+            }
+            if ( session->lignesAttendues < 0 ) {
+                // "etat N Z G L" : encore L lignes
+                int lignes = 0;
+                session->recu[k] = '\0';
+                sscanf(session->recu + debut, "etat %*d %*d %*d %d", &lignes);
+                session->lignesAttendues = lignes + 1;
+            }
+            debut = k + 1;
+            session->lignesAttendues--;
+            if ( session->lignesAttendues == 0 ) {
+                latences_ajouter(latences, horloge_ns() - session->envoi);
+                session->attend = false;
+            }
+        }
+        memmove(session->recu, session->recu + debut, session->nbRecu - debut);
+        session->nbRecu -= debut;
+        if ( session->nbRecu == REPONSE_MAX ) {
+            return false;
+        }
+    }
+}
+
+
+/**
+* @brief Ajoute une latence aux mesures
+* @param latences de type *t_latences : les mesures
+* @param valeur de type uint64_t : la latence en nanosecondes
+*/
+void latences_ajouter(t_latences *latences, uint64_t valeur) {
+    if ( latences->nb == latences->capa ) {
+        size_t capa = (latences->capa == 0) ? 65536 : latences->capa * 2;
+        uint64_t *valeurs = realloc(latences->valeurs, capa * sizeof(uint64_t));
+        if ( valeurs == NULL ) {
+            printf("ERREUR MEMOIRE");
+            exit(EXIT_FAILURE);
+        }
+        latences->valeurs = valeurs;
+        latences->capa = capa;
+    }
+    latences->valeurs[latences->nb++] = valeur;
+}
+
+
+/**
+* @brief Compare deux latences pour qsort()
+* @return -1, 0 ou 1
+*/
+int comparer(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+
+/**
+* @brief Donne un quantile des latences triées
+* @param latences de type *t_latences : les latences, triées
+* @param q de type double : le quantile (entre 0 et 1)
+* @return la latence en microsecondes, 0 sans mesure
+*/
+double quantile_us(t_latences *latences, double q) {
+    size_t k;
+
+    if ( latences->nb == 0 ) {
+        return 0.0;
+    }
+    k = (size_t)(q * (double)(latences->nb - 1) + 0.5);
+    return (double)latences->valeurs[k] * 1e-3;
+}
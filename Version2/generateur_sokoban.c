@@ -0,0 +1,745 @@
+/**
+* @file generateur_sokoban.c
+* @brief Générateur de niveaux Sokoban résolubles par construction
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* Chaque candidat part d'une salle creusée au hasard dont les caisses
+* sont posées sur les cibles (l'état gagné), puis le joueur tire les
+* caisses au hasard : en rejouant les tirages à l'envers, on obtient une
+* solution, donc le niveau est résoluble. Les candidats traversent une
+* chaîne générer → dédoublonner → noter → écrire : la génération et la
+* notation tournent sur tous les fils, le dédoublonnage et l'écriture se
+* font dans l'ordre des candidats, si bien qu'une graine donne toujours
+* les mêmes niveaux, quel que soit le nombre de fils. Deux candidats sont
+* des doublons s'ils ont la même clé canonique (voir sokoban_cle()), donc
+* aussi quand l'un est une rotation ou une symétrie de l'autre. La note
+* rejoue la solution avec libsokoban (ce qui vérifie le niveau) et
+* combine sa longueur en poussées au nombre moyen de poussées possibles
+* à chaque étape. N'utilise que libsokoban.h.
+*
+*/
+
+/* Fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include "libsokoban.h"
+
+/* Définition de constante*/
+#define TAILLE_MAX 64
+#define CASES_MAX (TAILLE_MAX * TAILLE_MAX)
+#define CAISSES_MAX 16
+#define TIRAGES_CAISSE 40       // tirages tentés par caisse
+#define TIRAGES_MAX (CAISSES_MAX * TIRAGES_CAISSE)
+#define ESSAIS_NIVEAU 1000      // candidats au plus par niveau demandé
+#define FENETRE 256             // candidats en cours dans la chaîne
+#define FILS_MAX 256
+#define G_MUR 1
+#define G_CAISSE 2
+#define G_CIBLE 4
+#define CAND_LIBRE 0
+#define CAND_EN_COURS 1
+#define CAND_GENERE 2
+#define CAND_ECHEC 3
+#define CAND_A_NOTER 4
+#define CAND_NOTE 5
+#define CAND_REJETE 6
+
+/* Définition de type*/
+/**
+* @brief Réglages de la génération
+*/
+typedef struct {
+    uint64_t graine;
+    int largeur;            // murs extérieurs compris
+    int hauteur;
+    int caisses;
+    long nombre;            // niveaux à écrire
+    double difficulteMin;
+    const char *dossier;
+    const char *index;      // index des niveaux déjà écrits, ou NULL
+} t_reglages;
+
+/**
+* @brief Un candidat de la chaîne
+*/
+typedef struct {
+    int etat;
+    uint8_t cases[CASES_MAX];   // niveau de départ (G_MUR, G_CAISSE, G_CIBLE)
+    int joueur;
+    int tirages[TIRAGES_MAX];   // case de la caisse avant le tirage * 4 + dir
+    int nbTirages;
+    t_sokoban *partie;          // le niveau chargé par libsokoban
+    uint64_t cle[2];            // clé canonique (voir sokoban_cle())
+    long coups;
+    long poussees;
+    double branchement;         // poussées possibles en moyenne par étape
+    double difficulte;
+} t_candidat;
+
+/**
+* @brief État partagé de la chaîne, protégé par verrou
+*/
+typedef struct {
+    pthread_mutex_t verrou;
+    pthread_cond_t travail;     // réveille les fils
+    pthread_cond_t resultat;    // réveille le fil principal
+    const t_reglages *reglages;
+    t_candidat *candidats;      // le candidat k est dans candidats[k % FENETRE]
+    long aNoter[FENETRE];       // file des candidats à noter
+    int debutNoter;
+    int nbNoter;
+    long prochain;              // prochain candidat à générer
+    long limite;                // nombre de candidats au plus
+    long libere;                // les candidats avant sont écrits ou rejetés
+    bool fini;
+} t_chaine;
+
+/* Définition de fonction*/
+double horloge();
+uint64_t hasard(uint64_t *etat);
+int zone(const uint8_t cases[], int largeur, int hauteur, int depart,
+    int distance[], int precedent[], int file[]);
+bool creuser_salle(uint8_t cases[], const t_reglages *r, uint64_t *etat);
+int niveau_texte(const t_candidat *c, const t_reglages *r, char texte[]);
+bool generer_candidat(t_candidat *c, long numero, const t_reglages *r);
+bool noter_candidat(t_candidat *c, const t_reglages *r);
+bool ecrire_niveau(t_candidat *c, const t_reglages *r, const char nom[]);
+long dernier_numero(const char dossier[]);
+void *fil_chaine(void *arg);
+int generer_niveaux(const t_reglages *r, int nbFils);
+
+
+/**
+* @brief Entrée du générateur
+* @return 0 si tous les niveaux demandés sont écrits, 1 sinon
+* generateur_sokoban [--nombre N] [--graine S] [--taille LxH]
+*   [--caisses C] [--difficulte D] [--threads N] [--dossier rep]
+*   [--index fichier]
+* Écrit rep/gen_0001.sok, rep/gen_0002.sok... en reprenant après le plus
+* grand numéro déjà présent dans rep, et une ligne JSON par niveau sur la
+* sortie standard. Avec --index, les niveaux déjà dans
+* l'index (même tournés ou retournés) sont écartés et les niveaux écrits
+* y sont ajoutés, ce qui évite les doublons d'une génération à l'autre.
+* Par défaut : 10 niveaux 12x12 à 3 caisses, graine 1, un fil par
+* processeur.
+*/
+int main(int argc, char *argv[]) {
+    t_reglages r = { 1, 12, 12, 3, 10, 0.0, ".", NULL };
+    int nbFils = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int a = 1; a < argc; a++) {
+        if ( strcmp(argv[a], "--nombre") == 0 && a + 1 < argc ) {
+            r.nombre = atol(argv[++a]);
+        } else if ( strcmp(argv[a], "--graine") == 0 && a + 1 < argc ) {
+            r.graine = strtoull(argv[++a], NULL, 10);
+        } else if ( strcmp(argv[a], "--taille") == 0 && a + 1 < argc ) {
+            if ( sscanf(argv[++a], "%dx%d", &r.largeur, &r.hauteur) != 2 ) {
+                r.largeur = 0;
+            }
+        } else if ( strcmp(argv[a], "--caisses") == 0 && a + 1 < argc ) {
+            r.caisses = atoi(argv[++a]);
+        } else if ( strcmp(argv[a], "--difficulte") == 0 && a + 1 < argc ) {
+            r.difficulteMin = atof(argv[++a]);
+        } else if ( strcmp(argv[a], "--threads") == 0 && a + 1 < argc ) {
+            nbFils = atoi(argv[++a]);
+        } else if ( strcmp(argv[a], "--dossier") == 0 && a + 1 < argc ) {
+            r.dossier = argv[++a];
+        } else if ( strcmp(argv[a], "--index") == 0 && a + 1 < argc ) {
+            r.index = argv[++a];
+        } else {
+            fprintf(stderr, "option inconnue : %s\n", argv[a]);
+            return 1;
+        }
+    }
+    if ( r.largeur < 5 || r.hauteur < 5 || r.largeur > TAILLE_MAX ||
+        r.hauteur > TAILLE_MAX ) {
+        fprintf(stderr, "taille invalide (de 5x5 à %dx%d)\n", TAILLE_MAX,
+            TAILLE_MAX);
+        return 1;
+    }
+    if ( r.caisses < 1 || r.caisses > CAISSES_MAX || r.nombre < 1 ) {
+        fprintf(stderr, "de 1 à %d caisses, au moins un niveau\n", CAISSES_MAX);
+        return 1;
+    }
+    if ( nbFils < 1 ) {
+        nbFils = 1;
+    }
+    if ( nbFils > FILS_MAX ) {
+        nbFils = FILS_MAX;
+    }
+    return generer_niveaux(&r, nbFils);
+}
+
+
+/**
+* @brief Donne l'heure d'une horloge monotone
+* @return le temps en secondes
+*/
+double horloge() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+
+/**
+* @brief Tire un nombre pseudo-aléatoire (xorshift64*)
+* @param etat de type *uint64_t : l'état du générateur, non nul
+* @return le nombre tiré
+*/
+uint64_t hasard(uint64_t *etat) {
+    *etat ^= *etat >> 12;
+    *etat ^= *etat << 25;
+    *etat ^= *etat >> 27;
+    return *etat * 0x2545F4914F6CDD1Dull;
+}
+
+
+/**
+* @brief Parcourt en largeur les cases accessibles au joueur sans pousser
+* de caisse
+* @param cases de type uint8_t[] : le plateau
+* @param largeur de type int : la largeur du plateau
+* @param hauteur de type int : la hauteur du plateau
+* @param depart de type int : la case du joueur
+* @param distance de type int[] : reçoit la distance de chaque case, -1
+* si elle est inaccessible
+* @param precedent de type int[] : reçoit la case d'où l'on vient, peut
+* être NULL
+* @param file de type int[] : tampon de largeur * hauteur cases
+* @return le nombre de cases accessibles
+*/
+int zone(const uint8_t cases[], int largeur, int hauteur, int depart,
+    int distance[], int precedent[], int file[]) {
+    int dep[4] = { -largeur, largeur, -1, 1 };
+    int debut = 0, fin = 0;
+
+    for (int k = 0; k < largeur * hauteur; k++) {
+        distance[k] = -1;
+    }
+    distance[depart] = 0;
+    file[fin++] = depart;
+    while ( debut < fin ) {
+        int c = file[debut++];
+        for (int d = 0; d < 4; d++) {
+            int v = c + dep[d];
+            if ( distance[v] < 0 && !(cases[v] & (G_MUR | G_CAISSE)) ) {
+                distance[v] = distance[c] + 1;
+                if ( precedent != NULL ) {
+                    precedent[v] = c;
+                }
+                file[fin++] = v;
+            }
+        }
+    }
+    return fin;
+}
+
+
+/**
+* @brief Creuse une salle : des rectangles de 1 à 3 cases de côté tirés
+* au hasard, dont on ne garde que la plus grande partie d'un seul tenant
+* @param cases de type uint8_t[] : reçoit le plateau, murs extérieurs
+* compris
+* @param r de type *t_reglages : la taille du plateau
+* @param etat de type *uint64_t : le générateur pseudo-aléatoire
+* @return false si la salle est trop petite pour les caisses
+*/
+bool creuser_salle(uint8_t cases[], const t_reglages *r, uint64_t *etat) {
+    int L = r->largeur, H = r->hauteur;
+    int nbCases = L * H;
+    int *distance = malloc(3 * (size_t)nbCases * sizeof(int));
+    int *file, *meilleure;
+    int taille = 0, depart = -1;
+    bool ok;
+
+    if ( distance == NULL ) {
+        return false;
+    }
+    file = distance + nbCases;
+    meilleure = file + nbCases;
+    memset(cases, G_MUR, (size_t)nbCases);
+    for (int n = 0; n < (L - 2) * (H - 2) / 4; n++) {
+        int i = 1 + (int)(hasard(etat) % (uint64_t)(H - 2));
+        int j = 1 + (int)(hasard(etat) % (uint64_t)(L - 2));
+        int h = 1 + (int)(hasard(etat) % 3);
+        int l = 1 + (int)(hasard(etat) % 3);
+        for (int a = i; a < i + h && a < H - 1; a++) {
+            for (int b = j; b < j + l && b < L - 1; b++) {
+                cases[a * L + b] = 0;
+            }
+        }
+    }
+
+    // plus grande partie d'un seul tenant
+    for (int k = 0; k < nbCases; k++) {
+        meilleure[k] = 0;
+    }
+    for (int k = 0; k < nbCases; k++) {
+        if ( cases[k] == 0 && !meilleure[k] ) {
+            int n = zone(cases, L, H, k, distance, NULL, file);
+            for (int m = 0; m < n; m++) {
+                meilleure[file[m]] = 1;
+            }
+            if ( n > taille ) {
+                taille = n;
+                depart = k;
+            }
+        }
+    }
+    ok = taille >= 3 * r->caisses + 4;
+    if ( ok ) {
+        zone(cases, L, H, depart, distance, NULL, file);
+        for (int k = 0; k < nbCases; k++) {
+            if ( distance[k] < 0 ) {
+                cases[k] = G_MUR;
+            }
+        }
+    }
+    free(distance);
+    return ok;
+}
+
+
+/**
+* @brief Met le niveau de départ d'un candidat au format .sok
+* @param c de type *t_candidat : le candidat
+* @param r de type *t_reglages : les réglages
+* @param texte de type char[] : reçoit le texte, sans zéro final
+* @return la longueur du texte
+*/
+int niveau_texte(const t_candidat *c, const t_reglages *r, char texte[]) {
+    int n = 0;
+
+    for (int i = 0; i < r->hauteur; i++) {
+        for (int j = 0; j < r->largeur; j++) {
+            int k = i * r->largeur + j;
+            char car = ' ';
+            if ( c->cases[k] & G_MUR ) {
+                car = '#';
+            } else if ( c->cases[k] & G_CAISSE ) {
+                car = (c->cases[k] & G_CIBLE) ? '*' : '$';
+            } else if ( k == c->joueur ) {
+                car = (c->cases[k] & G_CIBLE) ? '+' : '@';
+            } else if ( c->cases[k] & G_CIBLE ) {
+                car = '.';
+            }
+            texte[n++] = car;
+        }
+        texte[n++] = '\n';
+    }
+    return n;
+}
+
+
+/**
+* @brief Génère le candidat numero : salle, cibles, puis tirages depuis
+* l'état gagné, et charge le niveau obtenu avec libsokoban
+* @param c de type *t_candidat : reçoit le candidat
+* @param numero de type long : le numéro du candidat, qui fixe avec la
+* graine tous les tirages au hasard
+* @param r de type *t_reglages : les réglages
+* @return false si le candidat est à jeter (salle trop petite, caisse
+* restée sur sa cible, niveau refusé par libsokoban)
+*/
+bool generer_candidat(t_candidat *c, long numero, const t_reglages *r) {
+    int L = r->largeur, H = r->hauteur;
+    int nbCases = L * H;
+    int dep[4] = { -L, L, -1, 1 };
+    int distance[CASES_MAX], file[CASES_MAX];
+    int caisses[CAISSES_MAX], possibles[4 * CAISSES_MAX];
+    char texte[CASES_MAX + TAILLE_MAX];
+    uint64_t etat = r->graine + 0x9E3779B97F4A7C15ull * (uint64_t)(numero + 1);
+    int libres = 0, n, erreur;
+
+    // splitmix64 : des graines voisines donnent des suites sans rapport
+    etat = (etat ^ (etat >> 30)) * 0xBF58476D1CE4E5B9ull;
+    etat = (etat ^ (etat >> 27)) * 0x94D049BB133111EBull;
+    etat ^= etat >> 31;
+    if ( etat == 0 ) {
+        etat = 1;
+    }
+    c->partie = NULL;
+    c->nbTirages = 0;
+    if ( !creuser_salle(c->cases, r, &etat) ) {
+        return false;
+    }
+
+    // caisses sur les cibles, joueur sur une case libre
+    for (int k = 0; k < nbCases; k++) {
+        libres += c->cases[k] == 0;
+    }
+    for (int b = 0; b <= r->caisses; b++) {
+        int rang = (int)(hasard(&etat) % (uint64_t)(libres - b));
+        for (int k = 0; k < nbCases; k++) {
+            if ( c->cases[k] == 0 && rang-- == 0 ) {
+                if ( b < r->caisses ) {
+                    c->cases[k] = G_CAISSE | G_CIBLE;
+                    caisses[b] = k;
+                } else {
+                    c->cases[k] = G_CIBLE; // réservée le temps du tirage
+                    c->joueur = k;
+                }
+                break;
+            }
+        }
+    }
+    c->cases[c->joueur] = 0;
+
+    // tirages : le joueur, devant une caisse, recule en la tirant
+    for (int t = 0; t < r->caisses * TIRAGES_CAISSE; t++) {
+        int nb = 0, choix, b, d, v;
+        zone(c->cases, L, H, c->joueur, distance, NULL, file);
+        for (b = 0; b < r->caisses; b++) {
+            for (d = 0; d < 4; d++) {
+                v = caisses[b] + dep[d];
+                if ( distance[v] >= 0 &&
+                    !(c->cases[v + dep[d]] & (G_MUR | G_CAISSE)) ) {
+                    possibles[nb++] = b * 4 + d;
+                }
+            }
+        }
+        if ( nb == 0 ) {
+            break;
+        }
+        choix = possibles[hasard(&etat) % (uint64_t)nb];
+        b = choix / 4;
+        d = choix % 4;
+        c->tirages[c->nbTirages++] = caisses[b] * 4 + d;
+        c->cases[caisses[b]] &= (uint8_t)~G_CAISSE;
+        caisses[b] += dep[d];
+        c->cases[caisses[b]] |= G_CAISSE;
+        c->joueur = caisses[b] + dep[d];
+    }
+    for (int b = 0; b < r->caisses; b++) {
+        if ( c->cases[caisses[b]] & G_CIBLE ) {
+            return false;
+        }
+    }
+
+    n = niveau_texte(c, r, texte);
+    c->partie = sokoban_charger(texte, (size_t)n, &erreur);
+    if ( c->partie == NULL ) {
+        return false;
+    }
+    return sokoban_cle(c->partie, c->cle) == SOKOBAN_OK;
+}
+
+
+/**
+* @brief Note un candidat en rejouant sa solution (les tirages à l'envers,
+* reliés par les plus courts chemins du joueur) avec libsokoban, qui doit
+* finir gagnée. La longueur est celle de cette solution, pas forcément la
+* plus courte ; le branchement compte à chaque poussée les poussées
+* possibles depuis la zone du joueur.
+* @param c de type *t_candidat : le candidat, dont la partie est jouée
+* @param r de type *t_reglages : les réglages
+* @return false si la solution ne gagne pas la partie
+*/
+bool noter_candidat(t_candidat *c, const t_reglages *r) {
+    int L = r->largeur, H = r->hauteur;
+    int dep[4] = { -L, L, -1, 1 };
+    int distance[CASES_MAX], precedent[CASES_MAX], file[CASES_MAX];
+    int chemin[CASES_MAX];
+    uint8_t cases[CASES_MAX];
+    int joueur = c->joueur;
+    long possibles = 0;
+
+    memcpy(cases, c->cases, (size_t)(L * H));
+    c->coups = 0;
+    c->poussees = c->nbTirages;
+    for (int t = c->nbTirages - 1; t >= 0; t--) {
+        int origine = c->tirages[t] / 4, d = c->tirages[t] % 4;
+        int caisse = origine + dep[d], but = caisse + dep[d];
+        int lg = 0;
+
+        zone(cases, L, H, joueur, distance, precedent, file);
+        if ( distance[but] < 0 ) {
+            return false;
+        }
+        for (int k = 0; k < L * H; k++) {
+            if ( !(cases[k] & G_CAISSE) ) {
+                continue;
+            }
+            for (int e = 0; e < 4; e++) {
+                if ( distance[k - dep[e]] >= 0 &&
+                    !(cases[k + dep[e]] & (G_MUR | G_CAISSE)) ) {
+                    possibles++;
+                }
+            }
+        }
+
+        // chemin jusqu'à la case derrière la caisse, puis la poussée
+        for (int v = but; v != joueur; v = precedent[v]) {
+            chemin[lg++] = v;
+        }
+        for (int m = lg - 1; m >= 0; m--) {
+            int de = (m == lg - 1) ? joueur : chemin[m + 1];
+            int e = 0;
+            while ( de + dep[e] != chemin[m] ) {
+                e++;
+            }
+            if ( sokoban_jouer(c->partie, e) != e ) {
+                return false;
+            }
+        }
+        if ( sokoban_jouer(c->partie, d ^ 1) !=
+            ((d ^ 1) | SOKOBAN_POUSSEE) ) {
+            return false;
+        }
+        c->coups += lg + 1;
+        cases[caisse] &= (uint8_t)~G_CAISSE;
+        cases[origine] |= G_CAISSE;
+        joueur = caisse;
+    }
+    if ( !sokoban_gagne(c->partie) ) {
+        return false;
+    }
+    c->branchement = (c->poussees > 0) ?
+        (double)possibles / (double)c->poussees : 0.0;
+    c->difficulte = (double)c->poussees * log2(1.0 + c->branchement);
+    return true;
+}
+
+
+/**
+* @brief Écrit le niveau de départ d'un candidat au format .sok
+* @param c de type *t_candidat : le candidat
+* @param r de type *t_reglages : les réglages
+* @param nom de type char[] : le fichier à écrire
+* @return false si le fichier ne peut pas être écrit ou existe déjà
+*/
+bool ecrire_niveau(t_candidat *c, const t_reglages *r, const char nom[]) {
+    char texte[CASES_MAX + TAILLE_MAX];
+    int n = niveau_texte(c, r, texte);
+    FILE *f = fopen(nom, "wx");     // un niveau existant n'est pas écrasé
+    bool ok;
+
+    if ( f == NULL ) {
+        return false;
+    }
+    ok = fwrite(texte, 1, (size_t)n, f) == (size_t)n;
+    return (fclose(f) == 0) && ok;
+}
+
+
+/**
+* @brief Cherche le plus grand numéro des niveaux gen_NNNN.sok d'un
+* dossier, pour qu'une nouvelle génération écrive à la suite
+* @param dossier de type char[] : le dossier
+* @return le plus grand numéro, 0 si aucun niveau ou dossier illisible
+*/
+long dernier_numero(const char dossier[]) {
+    DIR *d = opendir(dossier);
+    struct dirent *entree;
+    long dernier = 0;
+
+    if ( d == NULL ) {
+        return 0;
+    }
+    while ( (entree = readdir(d)) != NULL ) {
+        long numero;
+        int fin = 0;
+        if ( sscanf(entree->d_name, "gen_%ld.sok%n", &numero, &fin) == 1 &&
+            entree->d_name[fin] == '\0' && fin > 0 && numero > dernier ) {
+            dernier = numero;
+        }
+    }
+    closedir(d);
+    return dernier;
+}
+
+
+/**
+* @brief Fil de la chaîne : note en priorité les candidats dédoublonnés,
+* sinon génère le candidat suivant tant que la fenêtre a de la place
+* @param arg de type *t_chaine : la chaîne
+* @return NULL
+*/
+void *fil_chaine(void *arg) {
+    t_chaine *ch = arg;
+
+    pthread_mutex_lock(&ch->verrou);
+    while ( !ch->fini ) {
+        if ( ch->nbNoter > 0 ) {
+            long k = ch->aNoter[ch->debutNoter];
+            t_candidat *c = &ch->candidats[k % FENETRE];
+            bool ok;
+            ch->debutNoter = (ch->debutNoter + 1) % FENETRE;
+            ch->nbNoter--;
+            pthread_mutex_unlock(&ch->verrou);
+            ok = noter_candidat(c, ch->reglages) &&
+                c->difficulte >= ch->reglages->difficulteMin;
+            pthread_mutex_lock(&ch->verrou);
+            c->etat = ok ? CAND_NOTE : CAND_REJETE;
+            pthread_cond_signal(&ch->resultat);
+        } else if ( ch->prochain < ch->limite &&
+            ch->prochain < ch->libere + FENETRE ) {
+            long k = ch->prochain++;
+            t_candidat *c = &ch->candidats[k % FENETRE];
+            bool ok;
+            c->etat = CAND_EN_COURS;
+            pthread_mutex_unlock(&ch->verrou);
+            ok = generer_candidat(c, k, ch->reglages);
+            pthread_mutex_lock(&ch->verrou);
+            c->etat = ok ? CAND_GENERE : CAND_ECHEC;
+            pthread_cond_signal(&ch->resultat);
+        } else {
+            pthread_cond_wait(&ch->travail, &ch->verrou);
+        }
+    }
+    pthread_mutex_unlock(&ch->verrou);
+    return NULL;
+}
+
+
+/**
+* @brief Fait tourner la chaîne jusqu'à avoir écrit r->nombre niveaux :
+* le fil principal dédoublonne les candidats générés et écrit les
+* candidats notés, les deux dans l'ordre des numéros
+* @param r de type *t_reglages : les réglages
+* @param nbFils de type int : le nombre de fils de génération et de notation
+* @return 0 si tous les niveaux sont écrits, 1 sinon
+*/
+int generer_niveaux(const t_reglages *r, int nbFils) {
+    static t_chaine ch;
+    pthread_t fils[FILS_MAX];
+    t_sokoban_index *vues;      // clés des candidats déjà dédoublonnés
+    t_sokoban_index *ecrits_idx = NULL;
+    int erreur;
+    long dedoublonne = 0, ecrits = 0, doublons = 0, echecs = 0, rejetes = 0;
+    long premier = dernier_numero(r->dossier) + 1;
+    double debut = horloge(), duree;
+
+    memset(&ch, 0, sizeof(ch));
+    ch.reglages = r;
+    ch.limite = r->nombre * ESSAIS_NIVEAU;
+    ch.candidats = calloc(FENETRE, sizeof(t_candidat));
+    vues = sokoban_index_ouvrir(NULL, &erreur);
+    if ( ch.candidats == NULL || vues == NULL ) {
+        fprintf(stderr, "ERREUR MEMOIRE\n");
+        return 1;
+    }
+    if ( r->index != NULL ) {
+        ecrits_idx = sokoban_index_ouvrir(r->index, &erreur);
+        if ( ecrits_idx == NULL ) {
+            fprintf(stderr, "index illisible : %s (%d)\n", r->index, erreur);
+            return 1;
+        }
+    }
+    pthread_mutex_init(&ch.verrou, NULL);
+    pthread_cond_init(&ch.travail, NULL);
+    pthread_cond_init(&ch.resultat, NULL);
+    for (int f = 0; f < nbFils; f++) {
+        pthread_create(&fils[f], NULL, fil_chaine, &ch);
+    }
+
+    pthread_mutex_lock(&ch.verrou);
+    while ( ecrits < r->nombre && ch.libere < ch.limite ) {
+        bool avance = false;
+
+        // dédoublonnage, dans l'ordre des candidats
+        while ( dedoublonne < ch.prochain ) {
+            t_candidat *c = &ch.candidats[dedoublonne % FENETRE];
+            if ( c->etat == CAND_GENERE ) {
+                int nouveau = sokoban_index_ajouter(vues, c->cle);
+                if ( nouveau < 0 ) {
+                    fprintf(stderr, "ERREUR MEMOIRE\n");
+                    exit(EXIT_FAILURE);
+                }
+                if ( nouveau == 0 || (ecrits_idx != NULL &&
+                    sokoban_index_contient(ecrits_idx, c->cle)) ) {
+                    sokoban_liberer(c->partie);
+                    c->partie = NULL;
+                    c->etat = CAND_REJETE;
+                    doublons++;
+                } else {
+                    c->etat = CAND_A_NOTER;
+                    ch.aNoter[(ch.debutNoter + ch.nbNoter) % FENETRE] =
+                        dedoublonne;
+                    ch.nbNoter++;
+                    pthread_cond_signal(&ch.travail);
+                }
+            } else if ( c->etat == CAND_ECHEC ) {
+                c->etat = CAND_REJETE;
+                echecs++;
+            } else {
+                break;
+            }
+            dedoublonne++;
+            avance = true;
+        }
+
+        // écriture, dans l'ordre des candidats
+        while ( ch.libere < dedoublonne && ecrits < r->nombre ) {
+            t_candidat *c = &ch.candidats[ch.libere % FENETRE];
+            if ( c->etat == CAND_NOTE ) {
+                char nom[4096];
+                pthread_mutex_unlock(&ch.verrou);
+                snprintf(nom, sizeof(nom), "%s/gen_%04ld.sok", r->dossier,
+                    premier + ecrits);
+                if ( !ecrire_niveau(c, r, nom) ) {
+                    fprintf(stderr, "écriture impossible : %s\n", nom);
+                    pthread_mutex_lock(&ch.verrou);
+                    ch.libere = ch.limite;
+                    break;
+                }
+                if ( ecrits_idx != NULL &&
+                    sokoban_index_ajouter(ecrits_idx, c->cle) < 0 ) {
+                    fprintf(stderr, "ERREUR MEMOIRE\n");
+                    exit(EXIT_FAILURE);
+                }
+                ecrits++;
+                printf("{\"niveau\":\"%s\",\"candidat\":%ld,\"caisses\":%d,"
+                    "\"coups\":%ld,\"poussees\":%ld,\"branchement\":%.2f,"
+                    "\"difficulte\":%.1f}\n", nom, ch.libere, r->caisses,
+                    c->coups, c->poussees, c->branchement, c->difficulte);
+                pthread_mutex_lock(&ch.verrou);
+            } else if ( c->etat == CAND_REJETE ) {
+                rejetes += c->partie != NULL;
+            } else {
+                break;
+            }
+            sokoban_liberer(c->partie);
+            c->partie = NULL;
+            c->etat = CAND_LIBRE;
+            ch.libere++;
+            avance = true;
+            pthread_cond_broadcast(&ch.travail);
+        }
+        if ( !avance ) {
+            pthread_cond_wait(&ch.resultat, &ch.verrou);
+        }
+    }
+    ch.fini = true;
+    pthread_cond_broadcast(&ch.travail);
+    pthread_mutex_unlock(&ch.verrou);
+    for (int f = 0; f < nbFils; f++) {
+        pthread_join(fils[f], NULL);
+    }
+    duree = horloge() - debut;
+
+    printf("{\"niveaux\":%ld,\"candidats\":%ld,\"doublons\":%ld,"
+        "\"echecs\":%ld,\"rejetes\":%ld,\"graine\":%llu,\"fils\":%d,"
+        "\"duree_s\":%.3f,\"candidats_s\":%.0f}\n", ecrits, ch.prochain,
+        doublons, echecs, rejetes, (unsigned long long)r->graine, nbFils,
+        duree, (double)ch.prochain / duree);
+    for (int k = 0; k < FENETRE; k++) {
+        sokoban_liberer(ch.candidats[k].partie);
+    }
+    free(ch.candidats);
+    sokoban_index_fermer(vues);
+    sokoban_index_fermer(ecrits_idx);
+    pthread_mutex_destroy(&ch.verrou);
+    pthread_cond_destroy(&ch.travail);
+    pthread_cond_destroy(&ch.resultat);
+    return (ecrits == r->nombre) ? 0 : 1;
+}
@@ -6,162 +6,344 @@
 * @date 09/11/2025
 *
 * Code du jeu Sokoban en C, en mode non graphique, dans le cadre de la SAE 1.01
+* Ce fichier est l'interface du jeu (terminal, affichage, modes en ligne
+* de commande) ; le moteur est dans libsokoban.c.
 *
 */
 
 /* Fichiers inclus */
-#include <stdlib.h>
-#include <stdio.h>
-#include <termios.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <stdbool.h>
-
-/* Définition de constante*/
-#define TAILLE 12
-#define DEP 1000
-#define VIDE ' '
-#define SOKOBAN '@'
-#define CIBLE '.'
-#define SOKOBAN_CIBLE '+'
-#define CAISSE '$'
-#define CAISSE_CIBLE '*'
-#define MUR '#'
-#define HAUT 'z'
-#define BAS 's'
-#define DROITE 'd'
-#define GAUCHE 'q'
-#define ABANDON 'x'
-#define RECOMMENCE 'r'
-#define UNDO 'u'
-#define ZOOM '+'
-#define DE_ZOOM '-'
-#define SOKO_GAUCHE 'g'
-#define SOKO_DROITE 'd'
-#define SOKO_HAUT 'h'
-#define SOKO_BAS 'b'
-#define CAISSE_GAUCHE 'G'
-#define CAISSE_DROITE 'D'
-#define CAISSE_HAUT 'H'
-#define CAISSE_BAS 'B'
-#define ZOOM_MAX 3
-#define ZOOM_MIN 1
-
-/* Définition de type*/
-typedef char t_plateau[TAILLE][TAILLE];
-typedef int t_tab_deplacement[DEP];
-
-/* Définition de fonction*/
-void affichage_fin(bool win, bool surrend, t_tab_deplacement depl, 
-    int count, t_plateau plato);
-void def_zoom(int *zoom, int coef);
-void enregistrer_plateau(t_plateau plat);
-void enregistrer_deplacement(t_tab_deplacement depl, int count);
-void afficher_entete(char nom[20],int count);
-void afficher_plateau(t_plateau plat, int zoom);
-void cherche_joueur(t_plateau plat, int *x, int *y);
-bool depl_case(t_plateau plat, int nextI, int nextJ, int coefX, int coefY);
-void mettre_a_jour_plateau(t_plateau plat, int i, int j, int nextI,
-     int nextJ, char destAvMv);
-bool deter_direct_code(char direct, int *coefX, int *coefY, char *codeD);
-void deplacer(t_plateau plat,t_tab_deplacement depl, char direct, 
-    int *count, int *x, int *y);
-void undo(t_plateau plat, t_tab_deplacement depl, int *count, int *x, int *y);
-bool gagne(t_plateau plat);
-bool verif_recommencer();
-bool verif_abandonner();
-void charger_partie(t_plateau plat, char fichier[]);
-void enregistrer_partie(t_plateau plat, char fichier[]);
-int kbhit();
-void enregistrerDeplacements(t_tab_deplacement t, int nb, char fic[]);
+#include "sokoban.h"
 
 
+#ifndef SOKOBAN_SANS_MAIN
 /**
 * @brief Entrée du programme
 * @return 0 : arrêt normal du programme
-* Charge une partie depuis un fichier en .sok et laisse 
-* le joueur jouer jusqu'à la fin du jeu, dans une limite
-* de 1000 déplacements enregistrable.
+* Charge une partie depuis un fichier en .sok, ou reprend une partie
+* enregistrée par sauver_partie(), et laisse le joueur jouer jusqu'à
+* la fin du jeu.
+* Avec l'option --stats, le nombre d'octets et d'appels système
+* par trame est affiché en fin de partie.
+* Avec l'option --impasses, l'entête signale quand une caisse est
+* poussée dans une position d'où la partie ne peut plus être gagnée.
+* L'écran n'est entièrement redessiné qu'au chargement, au redémarrage,
+* au changement de zoom et au redimensionnement du terminal : sinon
+* seules les cases modifiées et le compteur sont réécrits.
+* Avec --bench <fichier.sok> [coups], compare le nombre de coups par
+* seconde des codages en caractères, en bits par case et en bitboards.
+* Avec --solve <fichier.sok> [--mem Mo] [--out fichier], cherche une
+* solution et l'affiche avec les codes de déplacement enregistrés ;
+* --threads N lance la recherche parallèle sur N fils d'exécution.
+* Avec --replay <niveau.sok> <coups> [<niveau.sok> <coups> ...], rejoue
+* chaque fichier de coups sans terminal et indique s'il résout le niveau ;
+* les vérifications sont réparties sur --threads N fils (par défaut, un
+* par processeur). Les fichiers de coups sont des journaux binaires
+* (voir t_journal) ou des textes de codes de déplacement.
+* Avec --export-lurd <journal> <texte> et --import-lurd <niveau.sok>
+* <texte> <journal>, convertit un journal depuis ou vers la notation LURD.
+* Avec --pack <recueil> <N>, joue le niveau N d'un recueil .xsb/.txt ;
+* --pack-info <recueil> affiche son nombre de niveaux. L'index du
+* recueil est construit à la première ouverture et enregistré à côté.
+* Avec --dedup <index> <recueil|niveau.sok> [...], ajoute chaque niveau à
+* l'index de clés canoniques (voir cle_canonique()) et signale ceux qui y
+* étaient déjà, même tournés, retournés ou décalés.
+* Avec --batch <niveau.sok|sauvegarde> [script] [--digest], joue les
+* commandes du script (ou de l'entrée standard) sans terminal ni
+* confirmation, voir partie_script().
+* Compilé avec SOKOBAN_MESURES, le jeu mesure la latence entre une touche
+* et la trame qui suit, le traitement des déplacements et le rendu, et
+* compte trames, octets et appels système ; ces mesures sont ajoutées au
+* fichier --mesures <fichier> (sokoban_mesures.txt par défaut) sur la
+* touche m, sur SIGUSR1 et en fin de partie.
+* Compilé avec SOKOBAN_SANS_MAIN, le fichier ne fournit que les fonctions
+* du jeu (voir bench_sokoban.c et le Makefile).
 *
 */
-int main() {
-	t_plateau plato;
-	t_tab_deplacement depl;
+int main(int argc, char *argv[]) {
+	t_sokoban *partie;
+	const char *texte;
+	size_t taille;
 	char nom[20] = " ";
 	char touche;
-	int x = 0, y = 0;
-	int count = 0;
 	int zoom = 1;
 	bool win = false;
     bool surrend = false;
-	printf("Tappez un nom de fichier \n");
-	scanf("%s", nom);
-	charger_partie(plato, nom);
-	cherche_joueur(plato, &x, &y);
+	int lu;
+	bool stats = false;
+	t_trame trame;
+	t_cases_ecran modifs;
+	long coup;
+	int branche;
+	int ligne, colonne;
+	int erreur;
+	const char *message = NULL;
+	bool redessiner = true;
+	char *aResoudre = NULL;
+	char *niveauScript = NULL;
+	char *script = NULL;
+	bool resume = false;
+	char **aRejouer = NULL;
+	int nbRejouer = 0;
+	char *indexNom = NULL;
+	char **aIndexer = NULL;
+	int nbIndexer = 0;
+	char *sortie = NULL;
+	long memoireMo = SOL_MEMOIRE_DEFAUT;
+	int nbThreads = 0;
+	bool alerte = false;
+	t_pack pack;
+	char *packNom = NULL;
+	long packNumero = 0;
+	bool indexConstruit;
+#ifdef SOKOBAN_MESURES
+	char *fichierMesures = MESURES_FICHIER;
+#endif
+	MESURE_VARIABLE(toucheLue);
+	MESURE_VARIABLE(debut);
+	for (int a = 1; a < argc; a++) {
+		if ( strcmp(argv[a], "--stats") == 0 ) {
+			stats = true;
+#ifdef SOKOBAN_MESURES
+		} else if ( strcmp(argv[a], "--mesures") == 0 && a + 1 < argc ) {
+			fichierMesures = argv[++a];
+#endif
+		} else if ( strcmp(argv[a], "--impasses") == 0 ) {
+			alerte = true;
+		} else if ( strcmp(argv[a], "--bench") == 0 && a + 1 < argc ) {
+			long nbCoups = (a + 2 < argc) ? atol(argv[a + 2]) : BENCH_COUPS;
+			if ( nbCoups < 1 ) {
+				printf("--bench : au moins 1 coup\n");
+				return 1;
+			}
+			return bench_moteur(argv[a + 1], nbCoups);
+		} else if ( strcmp(argv[a], "--replay") == 0 && a + 2 < argc ) {
+			// les paires niveau / coups vont jusqu'à la prochaine option
+			aRejouer = &argv[a + 1];
+			while ( a + 2 < argc && strncmp(argv[a + 1], "--", 2) != 0 ) {
+				nbRejouer += 2;
+				a += 2;
+			}
+		} else if ( strcmp(argv[a], "--batch") == 0 && a + 1 < argc ) {
+			niveauScript = argv[++a];
+			if ( a + 1 < argc && strncmp(argv[a + 1], "--", 2) != 0 ) {
+				script = argv[++a];
+			}
+		} else if ( strcmp(argv[a], "--digest") == 0 ) {
+			resume = true;
+		} else if ( strcmp(argv[a], "--pack") == 0 && a + 2 < argc ) {
+			packNom = argv[++a];
+			packNumero = atol(argv[++a]);
+		} else if ( strcmp(argv[a], "--dedup") == 0 && a + 2 < argc ) {
+			indexNom = argv[++a];
+			aIndexer = &argv[a + 1];
+			while ( a + 1 < argc && strncmp(argv[a + 1], "--", 2) != 0 ) {
+				nbIndexer++;
+				a++;
+			}
+		} else if ( strcmp(argv[a], "--pack-info") == 0 && a + 1 < argc ) {
+			return infos_pack(argv[a + 1]);
+		} else if ( strcmp(argv[a], "--export-lurd") == 0 && a + 2 < argc ) {
+			return exporter_lurd(argv[a + 1], argv[a + 2]);
+		} else if ( strcmp(argv[a], "--import-lurd") == 0 && a + 3 < argc ) {
+			return importer_lurd(argv[a + 1], argv[a + 2], argv[a + 3]);
+		} else if ( strcmp(argv[a], "--solve") == 0 && a + 1 < argc ) {
+			aResoudre = argv[++a];
+		} else if ( strcmp(argv[a], "--mem") == 0 && a + 1 < argc ) {
+			memoireMo = atol(argv[++a]);
+			if ( memoireMo < 1 ) {
+				printf("--mem : au moins 1 Mo\n");
+				return 1;
+			}
+		} else if ( strcmp(argv[a], "--out") == 0 && a + 1 < argc ) {
+			sortie = argv[++a];
+		} else if ( strcmp(argv[a], "--threads") == 0 && a + 1 < argc ) {
+			nbThreads = atoi(argv[++a]);
+			if ( nbThreads < 1 ) {
+				nbThreads = 1;
+			}
+		}
+	}
+	if ( indexNom != NULL ) {
+		return dedoublonner(indexNom, aIndexer, nbIndexer);
+	}
+	if ( aRejouer != NULL ) {
+		return verifier_solutions(aRejouer, nbRejouer / 2, nbThreads);
+	}
+	if ( niveauScript != NULL ) {
+		return partie_script(niveauScript, script, resume);
+	}
+	if ( aResoudre != NULL ) {
+		return resoudre(aResoudre, memoireMo, sortie, nbThreads);
+	}
+	trame_init(&trame);
+	modifs.n = 0;
+	// lire_touche() lit directement le descripteur : pas de tampon stdio
+	setvbuf(stdin, NULL, _IONBF, 0);
+	if ( packNom != NULL ) {
+		if ( !pack_ouvrir(&pack, packNom, &indexConstruit) ) {
+			printf("ERREUR SUR FICHIER");
+			exit(EXIT_FAILURE);
+		}
+		if ( !pack_texte(&pack, packNumero, &texte, &taille) ) {
+			printf("le recueil n'a que %ld niveaux\n", pack.nbNiveaux);
+			exit(EXIT_FAILURE);
+		}
+		snprintf(nom, sizeof(nom), "niveau %ld", packNumero);
+		partie = sokoban_charger(texte, taille, &erreur);
+		verifier_memoire(erreur != SOKOBAN_ERREUR_MEMOIRE);
+		if ( partie == NULL ) {
+			printf("niveau invalide : %s\n", nom);
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		printf("Tappez un nom de fichier \n");
+		scanf("%s", nom);
+		// un nom de sauvegarde reprend la partie là où elle s'était arrêtée
+		partie = ouvrir_partie(nom);
+		if ( partie == NULL ) {
+			exit(EXIT_FAILURE);
+		}
+	}
+	// le niveau de départ reste en mémoire : recommencer ne relit rien
+	terminal_init();
 	while ( (win != true) && (surrend != true) ) {
-		afficher_entete(nom, count);
-		afficher_plateau(plato, zoom);
-		while (kbhit()==0)
-		{}
-		touche = getchar();
+		MESURE_TOP(debut);
+		trame_commencer(&trame);
+		if ( redessiner ) {
+			trame_effacer(&trame);
+			afficher_entete(&trame, nom, sokoban_nb_coups(partie),
+				alerte && sokoban_impasse(partie));
+			afficher_plateau(&trame, partie, zoom);
+			redessiner = false;
+		} else if ( modifs.n > 0 ) {
+			afficher_compteur(&trame, sokoban_nb_coups(partie),
+				alerte && sokoban_impasse(partie));
+			afficher_cases(&trame, partie, zoom, &modifs);
+		}
+		if ( message != NULL ) {
+			afficher_message(&trame, sokoban_nb_coups(partie),
+				alerte && sokoban_impasse(partie), message);
+			message = NULL;
+		}
+		if ( trame.taille > 0 ) {
+			placer_curseur(&trame, partie, zoom);
+			MESURE_FIN(rendu, debut);
+			trame_envoyer(&trame);
+			MESURE_FIN(toucheTrame, toucheLue);
+		}
+		modifs.n = 0;
+		lu = lire_touche(DELAI_INFINI);
+		MESURE_TOP(toucheLue);
+		if (lu == FIN_ENTREE) {
+			surrend = true;
+			break;
+		}
+		if (lu == REDIMENSION) {
+			redessiner = true;
+			continue;
+		}
+#ifdef SOKOBAN_MESURES
+		if (lu == DEMANDE_MESURES || lu == MESURES) {
+			mesures_ecrire(fichierMesures, &trame, 
+				(lu == MESURES) ? "touche" : "signal");
+			continue;
+		}
+		MESURE_COMPTER(touches);
+#endif
+		touche = (char)lu;
 		switch (touche) {
 			case ABANDON:
 				if ( verif_abandonner() ) {
                     surrend = true;
                 }
+				redessiner = true;
 				break;
 			case HAUT:
-				deplacer(plato, depl, HAUT, &count, &x, &y);
-				break;
 			case GAUCHE:
-				deplacer(plato, depl, GAUCHE, &count, &x, &y);
-				break;
 			case BAS:
-				deplacer(plato, depl, BAS, &count, &x, &y);
-				break;
 			case DROITE:
-				deplacer(plato, depl, DROITE, &count, &x, &y);
+			case UNDO:
+			case REFAIRE:
+				MESURE_TOP(debut);
+				jouer_touche(partie, touche, &modifs);
+				MESURE_FIN(traitement, debut);
 				break;
 			case RECOMMENCE:
                 if ( verif_recommencer() ){
-                    count = 0;
-				    charger_partie(plato, nom);
-				    cherche_joueur(plato, &x, &y);
+                    // les coups restent dans l'arbre et peuvent être refaits
+				    sokoban_recommencer(partie);
                 }
+				redessiner = true;
 				break;
-			case UNDO:
-				undo(plato, depl, &count, &x, &y);
+			case ALLER:
+				coup = demander_coup(sokoban_nb_enregistres(partie));
+				if ( coup >= 0 ) {
+				    sokoban_aller(partie, coup);
+				}
+				redessiner = true;
+				break;
+			case MARCHER:
+				// un seul coup de touche et un seul dessin pour tout le chemin
+				if ( demander_case(partie, &ligne, &colonne) ) {
+				    switch ( sokoban_marcher(partie, ligne, colonne) ) {
+				        case SOKOBAN_BLOQUE:
+				            message = ALERTE_INACCESSIBLE;
+				            break;
+				        case SOKOBAN_ERREUR_MEMOIRE:
+				            message = ALERTE_MEMOIRE;
+				            break;
+				    }
+				}
+				redessiner = true;
+				break;
+			case BRANCHE:
+				branche = demander_branche(partie);
+				if ( branche >= 0 ) {
+				    sokoban_choisir_variante(partie, branche);
+				}
+				redessiner = true;
 				break;
 			case ZOOM:
 				def_zoom(&zoom, 1);
+				redessiner = true;
 				break;
 			case DE_ZOOM:
 				def_zoom(&zoom, -1);
+				redessiner = true;
 				break;
 		}
-		system("clear");
-		win = gagne(plato);
+		win = sokoban_gagne(partie);
+	}
+	terminal_restaurer();
+	affichage_fin(win, surrend, partie);
+	if ( stats ) {
+		trame_afficher_stats(&trame);
+	}
+#ifdef SOKOBAN_MESURES
+	mesures_ecrire(fichierMesures, &trame, "fin de partie");
+#endif
+	trame_liberer(&trame);
+	sokoban_liberer(partie);
+	if ( packNom != NULL ) {
+		pack_fermer(&pack);
 	}
-	affichage_fin(win, surrend, depl, count, plato);
 	return 0;
 }
+#endif
 
 
 /**
 * @brief Gère l'affichage de la défaite/victoire de l'utilisateur
 * @param win de type bool : true si l'utilisateur a gagné
 * @param surrend de type bool : true si l'utilisateur a abandonné
-* @param depl de type t_tab_deplacement : le tableau des déplacements
-* @param count de type int : le nombre de déplacements
+* @param partie de type *t_sokoban : la partie
 */
-void affichage_fin(bool win, bool surrend, t_tab_deplacement depl, 
-    int count, t_plateau plato) {
+void affichage_fin(bool win, bool surrend, t_sokoban *partie) {
 	if ( win ) {
 		printf("Félicitation, vous avez gagnez ! \n");
-        enregistrer_deplacement(depl, count);
+        enregistrer_deplacement(partie);
 	} else if ( surrend ) {
-        enregistrer_plateau(plato);
-		enregistrer_deplacement(depl, count);
+        enregistrer_plateau(partie);
 		printf("Dommage, vous ferez mieux la prochaine fois !\n");
 	}
 }
@@ -182,10 +364,52 @@ void def_zoom(int *zoom, int coef) {
 
 
 /**
-* @brief Propose et effectue si nécéssaire l'enregistrement de la partie
-* @param plat de type t_plateau : le plateau de jeu
+* @brief Joue une touche de déplacement, d'annulation ou de reprise
+* @param partie de type *t_sokoban : la partie
+* @param touche de type char : HAUT, BAS, GAUCHE, DROITE, UNDO ou REFAIRE
+* @param modifs de type *t_cases_ecran : reçoit les cases modifiées
+*/
+void jouer_touche(t_sokoban *partie, char touche, t_cases_ecran *modifs) {
+    static const int di[4] = { -1, 1, 0, 0 };
+    static const int dj[4] = { 0, 0, -1, 1 };
+    int dir, coup, i, j;
+
+    modifs->n = 0;
+    if (touche == UNDO) {
+        coup = sokoban_annuler(partie);
+    } else if (touche == REFAIRE) {
+        coup = sokoban_refaire(partie);
+    } else if (deter_direct_code(touche, &dir)) {
+        coup = sokoban_jouer(partie, dir);
+        verifier_memoire(coup != SOKOBAN_ERREUR_MEMOIRE);
+    } else {
+        return;
+    }
+    if (coup < 0) {
+        return;
+    }
+    // cases alignées dans le sens du coup, depuis l'ancienne case du
+    // joueur (ou sa nouvelle case après une annulation)
+    dir = coup & 3;
+    sokoban_joueur(partie, &i, &j);
+    if (touche != UNDO) {
+        i -= di[dir];
+        j -= dj[dir];
+    }
+    modifs->n = (coup & SOKOBAN_POUSSEE) ? 3 : 2;
+    for (int k = 0; k < modifs->n; k++) {
+        modifs->ligne[k] = i + k * di[dir];
+        modifs->colonne[k] = j + k * dj[dir];
+    }
+}
+
+
+/**
+* @brief Propose et effectue si nécéssaire l'enregistrement de la partie,
+* historique compris, pour la reprendre plus tard (voir sauver_partie())
+* @param partie de type *t_sokoban : la partie
 */
-void enregistrer_plateau(t_plateau plat) {
+void enregistrer_plateau(t_sokoban *partie) {
 	char nom[20] = " ";
 	char action;
 	printf("Voulez vous enregistrez la partie ? (y/n) \n");
@@ -193,17 +417,18 @@ void enregistrer_plateau(t_plateau plat) {
 	if (action == 'y') {
 		printf("Veuillez nommez votre fichier \n");
 		scanf("%s", nom);
-		enregistrer_partie(plat, nom);
+		if ( !sauver_partie(nom, partie) ) {
+			printf("ERREUR SUR FICHIER");
+		}
 	}
 }
 
 
 /**
 * @brief Propose et effectue si nécéssaire l'enregistrement des déplacements
-* @param depl de type t_tab_deplacement : la liste des déplacements
-* @param count de type int : le nombre de coups joués
+* @param partie de type *t_sokoban : la partie
 */
-void enregistrer_deplacement(t_tab_deplacement depl, int count) {
+void enregistrer_deplacement(t_sokoban *partie) {
 	char nom[20] = " ";
 	char action;
 	printf("Voulez vous enregistrez vos déplacements ? (y/n) \n");
@@ -211,319 +436,542 @@ void enregistrer_deplacement(t_tab_deplacement depl, int count) {
 	if (action == 'y') {
 		printf("Veuillez nommez votre fichier \n");
 		scanf("%s", nom);
-		enregistrerDeplacements(depl, count, nom);
+		if ( !enregistrer_coups(partie, nom) ) {
+			printf("ERREUR SUR FICHIER");
+		}
 	}
 }
 
 
 /**
-* @brief Affiche l'entête de jeu
-* @param nom de type char : le nom du fichier
-* @param count de type int : le nombre de coups joués
+* @brief Prépare le tampon de trame
+* @param trame de type *t_trame : la trame à initialiser
+*/
+void trame_init(t_trame *trame) {
+    trame->donnees = malloc(TRAME_CAPACITE_INIT);
+    if (trame->donnees == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    trame->capacite = TRAME_CAPACITE_INIT;
+    trame->taille = 0;
+    trame->octetsTrame = 0;
+    trame->appelsTrame = 0;
+    trame->trames = 0;
+    trame->octetsTotal = 0;
+    trame->appelsTotal = 0;
+}
+
+
+/**
+* @brief Libère le tampon de trame
+* @param trame de type *t_trame : la trame
 */
-void afficher_entete(char nom[20],int count) {
-	printf("===== ENTETE =====\n");
-	printf("Partie : %s \n", nom);
-	printf("zqsd : déplacements\n");
-	printf("x : abandon \n");
-	printf("r : recommencer\n");
-	printf("u : annuler le déplacement\n");
-	printf("+ : Zoom le jeu\n");
-	printf("- : Dé-zoom le jeu\n");
-	printf("----- %d déplacements effectués ----- \n", count);
-	printf("==================\n");
+void trame_liberer(t_trame *trame) {
+    free(trame->donnees);
+    trame->donnees = NULL;
+    trame->capacite = 0;
+    trame->taille = 0;
 }
 
 
 /**
-* @brief Affiche le plateau de jeu avec un niveau de zoom
-* @param plat de type t_plateau : le plateau de jeu
-* @param niveauZoom de type int : le niveau de zoom (1 à 3)
+* @brief Commence une nouvelle trame vide
+* @param trame de type *t_trame : la trame
 */
-void afficher_plateau(t_plateau plat, int niveauZoom) {
-    char caractereAAfficher;
+void trame_commencer(t_trame *trame) {
+    trame->taille = 0;
+}
 
-    // Boucle sur les lignes du plateau (i)
-    for (int i = 0; i < TAILLE; i++) {
 
-        // Boucle pour le zoom vertical (z_i)
-        for (int z_i = 0; z_i < niveauZoom; z_i++) {
+/**
+* @brief Ajoute à la trame le retour du curseur en haut à gauche
+* et l'effacement de l'écran par séquences ANSI
+* @param trame de type *t_trame : la trame
+*/
+void trame_effacer(t_trame *trame) {
+    trame_ajouter(trame, EFFACER_ECRAN, sizeof(EFFACER_ECRAN) - 1);
+}
 
-            // Boucle sur les colonnes du plateau (j)
-            for (int j = 0; j < TAILLE; j++) {
-                
-                // Déterminer le caractère à afficher
-                if (plat[i][j] == CAISSE_CIBLE) {
-                    caractereAAfficher = CAISSE;
-                } else if (plat[i][j] == SOKOBAN_CIBLE) {
-                    caractereAAfficher = SOKOBAN;
-                } else {
-                    caractereAAfficher = plat[i][j];
-                }
 
-                // Boucle pour le zoom horizontal (z_j)
-                for (int z_j = 0; z_j < niveauZoom; z_j++) {
-                    printf("%c", caractereAAfficher);
-                }
-            }
-            // Nouvelle ligne pour le zoom vertical
-            printf("\n");
+/**
+* @brief Agrandit le tampon si nécessaire pour contenir n octets de plus
+* @param trame de type *t_trame : la trame
+* @param n de type size_t : le nombre d'octets à ajouter
+*/
+static void trame_reserver(t_trame *trame, size_t n) {
+    if (trame->taille + n > trame->capacite) {
+        size_t capacite = trame->capacite * 2;
+        while (trame->taille + n > capacite) {
+            capacite *= 2;
+        }
+        char *donnees = realloc(trame->donnees, capacite);
+        if (donnees == NULL) {
+            printf("ERREUR MEMOIRE");
+            exit(EXIT_FAILURE);
         }
+        trame->donnees = donnees;
+        trame->capacite = capacite;
+    }
+}
+
+
+/**
+* @brief Ajoute n octets à la trame
+* @param trame de type *t_trame : la trame
+* @param texte de type *char : les octets à ajouter
+* @param n de type size_t : le nombre d'octets
+*/
+void trame_ajouter(t_trame *trame, const char *texte, size_t n) {
+    trame_reserver(trame, n);
+    memcpy(trame->donnees + trame->taille, texte, n);
+    trame->taille += n;
+}
+
+
+/**
+* @brief Ajoute n fois le même caractère à la trame
+* @param trame de type *t_trame : la trame
+* @param c de type char : le caractère
+* @param n de type size_t : le nombre de répétitions
+*/
+void trame_repeter(t_trame *trame, char c, size_t n) {
+    trame_reserver(trame, n);
+    memset(trame->donnees + trame->taille, c, n);
+    trame->taille += n;
+}
+
+
+/**
+* @brief Ajoute un texte formaté à la trame
+* @param trame de type *t_trame : la trame
+* @param format de type *char : le format (comme printf)
+*/
+void trame_printf(t_trame *trame, const char *format, ...) {
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vsnprintf(trame->donnees + trame->taille,
+        trame->capacite - trame->taille, format, args);
+    va_end(args);
+    if (n >= 0 && (size_t)n >= trame->capacite - trame->taille) {
+        trame_reserver(trame, (size_t)n + 1);
+        va_start(args, format);
+        vsnprintf(trame->donnees + trame->taille,
+            trame->capacite - trame->taille, format, args);
+        va_end(args);
+    }
+    if (n > 0) {
+        trame->taille += (size_t)n;
     }
 }
 
 
 /**
-* @brief Recherche et initialise les coordonnées du joueur
-* @param plat de type t_plateau : le plateau de jeu
-* @param x de type *int : la ligne du joueur (sera modifié)
-* @param y de type *int : la colonne du joueur (sera modifié)
+* @brief Envoie la trame au terminal, en un seul write(2) sauf écriture partielle
+* @param trame de type *t_trame : la trame
 */
-void cherche_joueur(t_plateau plat, int *x, int *y) {
-    for (int i = 0; i < TAILLE; i++) {
-        for (int j = 0; j < TAILLE; j++) {
-            if ( (plat[i][j] == SOKOBAN) || (plat[i][j] == SOKOBAN_CIBLE) ) {
-                *x = i;
-                *y = j;
+void trame_envoyer(t_trame *trame) {
+    size_t envoye = 0;
+    ssize_t n;
+
+    fflush(stdout);
+    trame->appelsTrame = 0;
+    while (envoye < trame->taille) {
+        n = write(STDOUT_FILENO, trame->donnees + envoye, trame->taille - envoye);
+        trame->appelsTrame++;
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+            break;
         }
+        envoye += (size_t)n;
     }
+    trame->octetsTrame = (long)envoye;
+    trame->trames++;
+    trame->octetsTotal += trame->octetsTrame;
+    trame->appelsTotal += trame->appelsTrame;
+}
+
+
+/**
+* @brief Affiche les compteurs d'octets et d'appels système par trame
+* @param trame de type *t_trame : la trame
+*/
+void trame_afficher_stats(t_trame *trame) {
+    long trames = (trame->trames > 0) ? trame->trames : 1;
+    fprintf(stderr, "trames : %ld\n", trame->trames);
+    fprintf(stderr, "octets : %ld (%.1f par trame)\n", trame->octetsTotal,
+        (double)trame->octetsTotal / trames);
+    fprintf(stderr, "write() : %ld (%.2f par trame), fork() : 0\n",
+        trame->appelsTotal, (double)trame->appelsTotal / trames);
+}
+
+
+/**
+* @brief Ajoute l'entête de jeu à la trame
+* @param trame de type *t_trame : la trame en construction
+* @param nom de type char : le nom du fichier
+* @param count de type long : le nombre de coups joués
+* @param impasse de type bool : true pour signaler une partie perdue
+*/
+void afficher_entete(t_trame *trame, char nom[20], long count, bool impasse) {
+	trame_printf(trame, "===== ENTETE =====\n"
+		"Partie : %s \n"
+		"zqsd : déplacements\n"
+		"x : abandon \n"
+		"r : recommencer\n"
+		"u : annuler le déplacement\n"
+		"y : refaire le déplacement annulé\n"
+		"g : aller au coup n°\n"
+		"c : aller jusqu'à une case\n"
+		"b : choisir la variante à refaire\n"
+		"+ : Zoom le jeu\n"
+		"- : Dé-zoom le jeu\n"
+		"----- %ld déplacements effectués ----- %s\n"
+		"==================\n", nom, count, impasse ? ALERTE_IMPASSE : "");
+}
+
+
+/**
+* @brief Réécrit uniquement la ligne du compteur de l'entête
+* @param trame de type *t_trame : la trame en construction
+* @param count de type long : le nombre de coups joués
+* @param impasse de type bool : true pour signaler une partie perdue
+*/
+void afficher_compteur(t_trame *trame, long count, bool impasse) {
+    trame_printf(trame, "\033[%d;1H----- %ld déplacements effectués ----- %s\033[K",
+        LIGNE_COMPTEUR, count, impasse ? ALERTE_IMPASSE : "");
 }
 
 
 /**
-* @brief Tente de déplacer une caisse si possible
-* @param plat de type t_plateau : le plateau de jeu
-* @param nextI de type int : la ligne où se trouve la caisse (future position Sokoban)
-* @param nextJ de type int : la colonne où se trouve la caisse (future position Sokoban)
-* @param coefX de type int : le coefficient de déplacement sur X
-* @param coefY de type int : le coefficient de déplacement sur Y
-* @return true si la caisse a été déplacée, false sinon (mur, hors limite, ou autre caisse)
+* @brief Réécrit la ligne du compteur suivie d'un message, qui disparaît
+* dès que le compteur est réécrit
+* @param trame de type *t_trame : la trame en construction
+* @param count de type long : le nombre de coups joués
+* @param impasse de type bool : true pour signaler une partie perdue
+* @param message de type char[] : le message
 */
-bool depl_case(t_plateau plat, int nextI, int nextJ, int coefX, int coefY) {
-    int boxI = nextI + coefX;
-    int boxJ = nextJ + coefY;
+void afficher_message(t_trame *trame, long count, bool impasse,
+    const char message[]) {
+    afficher_compteur(trame, count, impasse);
+    trame_printf(trame, " %s", message);
+}
+
 
-    if ( boxI < 0 || boxI >= TAILLE || boxJ < 0 || 
-        boxJ >= TAILLE || plat[boxI][boxJ] == MUR ) {
-        return false; 
+/**
+* @brief Donne le caractère affiché pour une case du plateau
+* @param c de type char : le caractère .sok de la case (voir sokoban_case())
+* @return le caractère à afficher (le joueur et les caisses masquent la cible)
+*/
+static char caractere_affiche(char c) {
+    switch (c) {
+        case SOKOBAN_CIBLE:
+            return SOKOBAN;
+        case CAISSE_CIBLE:
+            return CAISSE;
+        default:
+            return c;
     }
+}
 
-    char destinationCaisse = plat[boxI][boxJ];
-    
-    if (destinationCaisse == VIDE || destinationCaisse == CIBLE) {
-        if (destinationCaisse == VIDE) {
-            plat[boxI][boxJ] = CAISSE;
-        } else {
-            plat[boxI][boxJ] = CAISSE_CIBLE;
+
+/**
+* @brief Réécrit uniquement les cases modifiées, par adressage du curseur
+* @param trame de type *t_trame : la trame en construction
+* @param partie de type *t_sokoban : la partie
+* @param niveauZoom de type int : le niveau de zoom (1 à 3)
+* @param modifs de type *t_cases_ecran : les cases à réécrire
+*/
+void afficher_cases(t_trame *trame, t_sokoban *partie, int niveauZoom,
+    t_cases_ecran *modifs) {
+    char c;
+    int i, j;
+    for (int k = 0; k < modifs->n; k++) {
+        i = modifs->ligne[k];
+        j = modifs->colonne[k];
+        c = caractere_affiche(sokoban_case(partie, i, j));
+        for (int z_i = 0; z_i < niveauZoom; z_i++) {
+            trame_printf(trame, "\033[%d;%dH",
+                ENTETE_LIGNES + i * niveauZoom + z_i + 1,
+                j * niveauZoom + 1);
+            trame_repeter(trame, c, (size_t)niveauZoom);
         }
-        return true; 
     }
+}
 
-    return false; 
+
+/**
+* @brief Place le curseur sous le plateau, là où s'affichent les questions
+* @param trame de type *t_trame : la trame en construction
+* @param partie de type *t_sokoban : la partie
+* @param niveauZoom de type int : le niveau de zoom (1 à 3)
+*/
+void placer_curseur(t_trame *trame, t_sokoban *partie, int niveauZoom) {
+    trame_printf(trame, "\033[%d;1H",
+        ENTETE_LIGNES + sokoban_hauteur(partie) * niveauZoom + 1);
 }
 
 
 /**
-* @brief Met à jour le plateau de jeu après un déplacement réussi du Sokoban
-* @param plat de type t_plateau : le plateau de jeu
-* @param i de type int : l'ancienne ligne du Sokoban
-* @param j de type int : l'ancienne colonne du Sokoban
-* @param nextI de type int : la nouvelle ligne du Sokoban
-* @param nextJ de type int : la nouvelle colonne du Sokoban
-* @param destAvMv de type char : le contenu de la case (nextI, nextJ) avant le déplacement
+* @brief Ajoute le plateau de jeu à la trame avec un niveau de zoom
+* @param trame de type *t_trame : la trame en construction
+* @param partie de type *t_sokoban : la partie
+* @param niveauZoom de type int : le niveau de zoom (1 à 3)
 */
-void mettre_a_jour_plateau(t_plateau plat, int i, int j, int nextI,
-     int nextJ, char destAvMv) {
-    if (plat[i][j] == SOKOBAN_CIBLE) {
-        plat[i][j] = CIBLE;
-    } else {
-        plat[i][j] = VIDE;
-    }
+void afficher_plateau(t_trame *trame, t_sokoban *partie, int niveauZoom) {
+    int hauteur = sokoban_hauteur(partie);
+    int largeur = sokoban_largeur(partie);
+    size_t debutLigne;
+    size_t longueurLigne;
+
+    // Boucle sur les lignes du plateau (i)
+    for (int i = 0; i < hauteur; i++) {
+        debutLigne = trame->taille;
 
-    if (destAvMv == CIBLE || destAvMv == CAISSE_CIBLE) {
-        plat[nextI][nextJ] = SOKOBAN_CIBLE;
-    } else { 
-        plat[nextI][nextJ] = SOKOBAN;
+        // Boucle sur les colonnes du plateau (j), avec zoom horizontal
+        for (int j = 0; j < largeur; j++) {
+            trame_repeter(trame, caractere_affiche(sokoban_case(partie, i, j)),
+                (size_t)niveauZoom);
+        }
+        trame_ajouter(trame, "\n", 1);
+
+        // Zoom vertical : la ligne construite est recopiée
+        longueurLigne = trame->taille - debutLigne;
+        for (int z_i = 1; z_i < niveauZoom; z_i++) {
+            trame_reserver(trame, longueurLigne);
+            memcpy(trame->donnees + trame->taille,
+                trame->donnees + debutLigne, longueurLigne);
+            trame->taille += longueurLigne;
+        }
     }
 }
 
 
+// Représentation en bitboards
+
+
 /**
-* @brief Détermine les coefficients et le code pour la direction donnée
-* @param direct de type char : direction
-* @param coefX de type *int : coefficient de déplacement ligne 
-* @param coefY de type *int : coefficient de déplacement colonne 
-* @param codeD de type *char : code du déplacement Sokoban simple
-* @return true si la direction est reconnue, false sinon
+* @brief Teste le bit d'une case dans un ensemble
+* @param v de type *uint64_t : l'ensemble
+* @param k de type int : l'indice de la case
+* @return 1 si la case appartient à l'ensemble, 0 sinon
 */
-bool deter_direct_code(char direct, int *coefX, int *coefY, char *codeD) {
-    bool var = false;
-    switch (direct) {
-        case HAUT:
-            *coefX = -1; 
-            *codeD = SOKO_HAUT;
-            var = true;
-            break;
-        case GAUCHE:
-            *coefY = -1;
-            *codeD = SOKO_GAUCHE;
-            var = true;
-            break;
-        case BAS:
-            *coefX = 1;
-            *codeD = SOKO_BAS;
-            var = true;
-            break;
-        case DROITE:
-            *coefY = 1;
-            *codeD = SOKO_DROITE;
-            var = true;
-            break;
+static inline int bb_test(const uint64_t *v, int k) {
+    return (int)((v[k / BB_BITS] >> (k % BB_BITS)) & 1u);
+}
+
+
+/**
+* @brief Construit les bitboards d'un plateau
+* @param bb de type *t_bitboard : les bitboards (alloués ici)
+* @param plat de type *t_plateau : le plateau de jeu
+* @param joueur de type int : la case du joueur
+*/
+void bitboard_depuis_plateau(t_bitboard *bb, t_plateau *plat, int joueur) {
+    int total = (plat->hauteur + 2 * BORDURE) * plat->pas;
+
+    bb->largeur = plat->largeur;
+    bb->hauteur = plat->hauteur;
+    bb->pas = plat->pas;
+    for (int d = 0; d < NB_DIRECTIONS; d++) {
+        bb->voisin[d] = plat->voisin[d];
+    }
+    bb->nbMots = (total + BB_BITS - 1) / BB_BITS;
+    bb->joueur = joueur;
+    bb->murs = calloc(3 * (size_t)bb->nbMots, sizeof(uint64_t));
+    if (bb->murs == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    bb->caisses = bb->murs + bb->nbMots;
+    bb->cibles = bb->caisses + bb->nbMots;
+    for (int k = 0; k < total; k++) {
+        uint64_t bit = (uint64_t)1 << (k % BB_BITS);
+        uint8_t c = plat->cases[k];
+        if (c & CASE_MUR) {
+            bb->murs[k / BB_BITS] |= bit;
+        }
+        if (c & CASE_CAISSE) {
+            bb->caisses[k / BB_BITS] |= bit;
+        }
+        if (c & CASE_CIBLE) {
+            bb->cibles[k / BB_BITS] |= bit;
+        }
     }
-    return var;
 }
 
 
 /**
-* @brief Gère la globalité du déplacement du Sokoban
-* @param plat de type t_plateau : le plateau de jeu
-* @param depl de type t_tab_deplacement : la liste des déplacements
-* @param direct de type char : la direction du déplacement
-* @param count de type *int : le compteur de coups
-* @param x de type *int : la ligne du joueur
-* @param y de type *int : la colonne du joueur
+* @brief Recopie l'état des bitboards dans un plateau de même géométrie
+* @param bb de type *t_bitboard : les bitboards
+* @param plat de type *t_plateau : le plateau (déjà alloué, mêmes dimensions)
 */
-void deplacer(t_plateau plat, t_tab_deplacement depl, char direct, 
-              int *count, int *x, int *y) {
-    int coefX = 0;
-    int coefY = 0;
-    char codeD = ' '; 
-    bool mouvementValide;
-    bool pousseeReussie = true;
-    int i = *x; 
-    int j = *y;
-    int nextI;
-    int nextJ;
-    char caseSuivante;
+void bitboard_vers_plateau(t_bitboard *bb, t_plateau *plat) {
+    int total = (bb->hauteur + 2 * BORDURE) * bb->pas;
+    int n = 0;
+
+    for (int k = 0; k < total; k++) {
+        plat->cases[k] = (uint8_t)(bb_test(bb->murs, k) * CASE_MUR
+            | bb_test(bb->caisses, k) * CASE_CAISSE
+            | bb_test(bb->cibles, k) * CASE_CIBLE);
+        n += bb_test(bb->cibles, k) & !bb_test(bb->caisses, k);
+    }
+    plat->cases[bb->joueur] |= CASE_JOUEUR;
+    plat->cibles = n;
+}
 
-    mouvementValide = deter_direct_code(direct, &coefX, &coefY, &codeD); 
 
-    if (mouvementValide) {
+/**
+* @brief Libère les bitboards
+* @param bb de type *t_bitboard : les bitboards
+*/
+void bitboard_liberer(t_bitboard *bb) {
+    free(bb->murs);
+    bb->murs = NULL;
+    bb->caisses = NULL;
+    bb->cibles = NULL;
+}
 
-        nextI = i + coefX;
-        nextJ = j + coefY;
 
-        if ( (nextI < 0) || (nextI >= TAILLE) || (nextJ < 0) || 
-        (nextJ >= TAILLE) || (plat[nextI][nextJ] == MUR) ) { 
-            mouvementValide = false; 
-        } else {
-            caseSuivante = plat[nextI][nextJ];
-
-            if ( (caseSuivante == CAISSE) || (caseSuivante == CAISSE_CIBLE) ) {
-                pousseeReussie = depl_case(plat, nextI, nextJ, coefX, coefY);
-                
-                if (!pousseeReussie) {
-                    mouvementValide = false;
-
-                } else {
-                    if (codeD == SOKO_HAUT) { codeD = CAISSE_HAUT; }
-                    else if (codeD == SOKO_BAS) { codeD = CAISSE_BAS; }
-                    else if (codeD == SOKO_GAUCHE) { codeD = CAISSE_GAUCHE; }
-                    else { codeD = CAISSE_DROITE; }
-                }
-            }
+/**
+* @brief Joue un coup avec les mêmes règles que jouer_coup()
+* @param bb de type *t_bitboard : les bitboards
+* @param dir de type int : la direction (DIR_*)
+* @return le coup joué (dir, plus COUP_POUSSEE si une caisse a été
+* poussée) ou -1 si le coup est impossible
+*/
+int bitboard_jouer(t_bitboard *bb, int dir) {
+    int decalage = bb->voisin[dir];
+    int suivant = bb->joueur + decalage;
+    int dest;
 
-            if (mouvementValide) {
-                mettre_a_jour_plateau(plat, i, j, nextI, nextJ, caseSuivante);
-                depl[*count] = codeD;
-                (*count)++;
-                *x = nextI;
-                *y = nextJ;
-            }
+    if (bb_test(bb->murs, suivant)) {
+        return -1;
+    }
+    if (bb_test(bb->caisses, suivant)) {
+        dest = suivant + decalage;
+        if (bb_test(bb->murs, dest) | bb_test(bb->caisses, dest)) {
+            return -1;
         }
+        bb->caisses[suivant / BB_BITS] ^= (uint64_t)1 << (suivant % BB_BITS);
+        bb->caisses[dest / BB_BITS] ^= (uint64_t)1 << (dest % BB_BITS);
+        bb->joueur = suivant;
+        return dir | COUP_POUSSEE;
     }
+    bb->joueur = suivant;
+    return dir;
 }
 
 
 /**
-* @brief Effectue l'annulation du dernier déplacement
-* @param plat de type t_plateau : le plateau de jeu
-* @param depl de type t_tab_deplacement : la liste des anciens déplacements
-* @param count de type *int : le compteur de coups
-* @param x de type *int : coordonnee x actuelle du joueur
-* @param y de type *int : coordonnee y actuelle du joueur
+* @brief Annule un coup joué par bitboard_jouer()
+* @param bb de type *t_bitboard : les bitboards
+* @param coup de type int : le coup à annuler
 */
-void undo(t_plateau plat, t_tab_deplacement depl, int *count, int *x, int *y) {
-    if (*count <= 0) {
-        return; 
+void bitboard_annuler(t_bitboard *bb, int coup) {
+    int decalage = bb->voisin[coup & 3];
+    int pos = bb->joueur;
+
+    if (coup & COUP_POUSSEE) {
+        int caisse = pos + decalage;
+        bb->caisses[caisse / BB_BITS] ^= (uint64_t)1 << (caisse % BB_BITS);
+        bb->caisses[pos / BB_BITS] ^= (uint64_t)1 << (pos % BB_BITS);
     }
-    char lastDep = depl[*count - 1];
-    int coefX = 0;
-    int coefY = 0;
-    switch (lastDep) {
-        case SOKO_HAUT: case CAISSE_HAUT:
-            coefX = 1; 
-            break;
-        case SOKO_BAS: case CAISSE_BAS:
-            coefX = -1; 
-            break;
-        case SOKO_GAUCHE: case CAISSE_GAUCHE:
-            coefY = 1; 
-            break;
-        case SOKO_DROITE: case CAISSE_DROITE:
-            coefY = -1; 
-            break;
+    bb->joueur = pos - decalage;
+}
+
+
+/**
+* @brief Vérifie si toutes les cibles sont couvertes
+* @param bb de type *t_bitboard : les bitboards
+* @return true si les caisses occupent exactement les cibles
+* La boucle sans branchement est vectorisée par le compilateur.
+*/
+bool bitboard_gagne(t_bitboard *bb) {
+    uint64_t diff = 0;
+    for (int m = 0; m < bb->nbMots; m++) {
+        diff |= bb->caisses[m] ^ bb->cibles[m];
     }
-    int nextX = *x + coefX;
-    int nextY = *y + coefY;
-    if ( (lastDep == CAISSE_HAUT) || (lastDep == CAISSE_BAS) || 
-         (lastDep == CAISSE_GAUCHE) || (lastDep == CAISSE_DROITE) ) {
-        int beforeX = *x - coefX;
-        int beforeY = *y - coefY;
-        if (plat[beforeX][beforeY] == CAISSE_CIBLE) {
-            plat[beforeX][beforeY] = CIBLE;
-        } else {
-            plat[beforeX][beforeY] = VIDE;
-        }
-        if (plat[*x][*y] == SOKOBAN_CIBLE) {
-            plat[*x][*y] = CAISSE_CIBLE;
-        } else {
-            plat[*x][*y] = CAISSE;
-        }
-    } else {
-        if (plat[*x][*y] == SOKOBAN_CIBLE) {
-            plat[*x][*y] = CIBLE;
-        } else {
-            plat[*x][*y] = VIDE;
-        }
+    return diff == 0;
+}
+
+
+/**
+* @brief Demande au joueur le numéro du coup où aller
+* @param max de type long : le dernier coup enregistré
+* @return le numéro du coup, ou -1 si la réponse n'est pas un nombre
+*/
+long demander_coup(long max) {
+    long n = -1;
+    printf("Aller au coup n° (0 à %ld) ? \n", max);
+    terminal_suspendre();
+    if ( scanf(" %ld", &n) != 1 ) {
+        scanf("%*s");
+        n = -1;
     }
-    if (plat[nextX][nextY] == CIBLE) {
-        plat[nextX][nextY] = SOKOBAN_CIBLE;
-    } else {
-        plat[nextX][nextY] = SOKOBAN;
+    terminal_reprendre();
+    return n;
+}
+
+
+/**
+* @brief Demande au joueur la case où aller
+* @param partie de type *t_sokoban : la partie
+* @param ligne de type *int : reçoit la ligne, à partir de 0
+* @param colonne de type *int : reçoit la colonne, à partir de 0
+* @return false si la réponse n'est pas une case du plateau
+*/
+bool demander_case(t_sokoban *partie, int *ligne, int *colonne) {
+    int i = 0, j = 0;
+    bool ok = true;
+    printf("Aller à la case (ligne 1 à %d, colonne 1 à %d) ? \n", 
+        sokoban_hauteur(partie), sokoban_largeur(partie));
+    terminal_suspendre();
+    if ( scanf(" %d %d", &i, &j) != 2 ) {
+        scanf("%*s");
+        ok = false;
     }
-    (*count)--;
-    *x = nextX;
-    *y = nextY;
+    terminal_reprendre();
+    *ligne = i - 1;
+    *colonne = j - 1;
+    return ok && i >= 1 && i <= sokoban_hauteur(partie) && j >= 1 && 
+        j <= sokoban_largeur(partie);
 }
 
 
 /**
-* @brief Vérifie si le joueur a gagné ou non
-* @param plat de type t_plateau : le plateau de jeu
-* @return un booléen : true si gagné et false sinon
+* @brief Affiche les variantes jouées depuis la position actuelle et
+* demande laquelle suivre
+* @param partie de type *t_sokoban : la partie
+* @return le numéro de la variante choisie, ou -1
 */
-bool gagne(t_plateau plat) {
-	bool result = true;
-	for(int i=0; i < TAILLE; i++){
-		for(int j=0; j < TAILLE; j++){
-			if((plat[i][j] == CIBLE)||(plat[i][j] == SOKOBAN_CIBLE)) {
-				result = false;
-			}
-		}
-	}
-	return result;
+int demander_branche(t_sokoban *partie) {
+    static const char *directions[4] = {"haut", "bas", "gauche", "droite"};
+    int coups[4];
+    long longueurs[4];
+    int nb = sokoban_variantes(partie, coups, longueurs);
+    int choix = -1;
+
+    if (nb == 0) {
+        return -1;
+    }
+    printf("Variantes depuis le coup %ld :\n", sokoban_nb_coups(partie));
+    for (int k = 0; k < nb; k++) {
+        printf("%d : %s%s, %ld coups%s\n", k + 1, directions[coups[k] & 3],
+            (coups[k] & COUP_POUSSEE) ? " (poussée)" : "", longueurs[k],
+            (k == 0) ? " (suivie)" : "");
+    }
+    printf("Variante à suivre ? \n");
+    terminal_suspendre();
+    if ( scanf(" %d", &choix) != 1 ) {
+        scanf("%*s");
+    }
+    terminal_reprendre();
+    return (choix >= 1 && choix <= nb) ? choix - 1 : -1;
 }
 
 
@@ -535,7 +983,9 @@ bool verif_recommencer() {
     bool res = false;
     char action = ' ';
     printf("Êtes vous sûr de vouloir recommencer ? (y/n) \n");
+    terminal_suspendre();
     scanf(" %c", &action);
+    terminal_reprendre();
     if ( action == 'y' ) {
         res = true;
     }
@@ -551,7 +1001,9 @@ bool verif_abandonner() {
     bool res = false;
     char action = ' ';
     printf("Êtes vous sûr de vouloir abandonner ? (y/n) \n");
+    terminal_suspendre();
     scanf(" %c", &action);
+    terminal_reprendre();
     if ( action == 'y' ) {
         res = true;
     }
@@ -562,76 +1014,2735 @@ bool verif_abandonner() {
 // Code fourni
 
 
-void charger_partie(t_plateau plateau, char fichier[]){
-    FILE * f;
-    char finDeLigne;
+/**
+* @brief Arrête le programme si une allocation du moteur a échoué
+* @param ok de type bool : le résultat de la fonction du moteur
+*/
+void verifier_memoire(bool ok) {
+    if (!ok) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+}
+
 
-    f = fopen(fichier, "r");
-    if (f==NULL){
+/**
+* @brief Cherche la case du joueur d'un niveau chargé
+* @param plat de type *t_plateau : le niveau
+* @param joueur de type *int : reçoit la case du joueur, -1 s'il n'y en a pas
+* @return true si le niveau a un joueur
+*/
+bool trouver_joueur(t_plateau *plat, int *joueur) {
+    *joueur = -1;
+    cherche_joueur(plat, joueur);
+    return *joueur >= 0;
+}
+
+
+/**
+* @brief Lit un niveau .sok de taille quelconque sans arrêter le programme
+* @param plateau de type *t_plateau : le plateau (l'ancien contenu est libéré)
+* @param fichier de type char : le nom du fichier
+* @param joueur de type *int : reçoit la case du joueur, qui est alors
+* exigée (NULL pour ne pas la chercher)
+* @return SOKOBAN_OK, SOKOBAN_FICHIER si le fichier n'est pas un fichier
+* ordinaire lisible, SOKOBAN_ERREUR_MEMOIRE, SOKOBAN_INVALIDE si le
+* joueur est demandé et que le niveau n'en a pas
+* Le fichier est projeté en mémoire et lu en place par
+* plateau_depuis_texte(), sans copie.
+*/
+int lire_niveau(t_plateau *plateau, char fichier[], int *joueur){
+    struct stat infos;
+    char *texte = "";
+    bool ok;
+    int fd;
+
+    fd = open(fichier, O_RDONLY);
+    if (fd < 0) {
+        return SOKOBAN_FICHIER;
+    }
+    if (fstat(fd, &infos) != 0 || !S_ISREG(infos.st_mode)) {
+        close(fd);
+        return SOKOBAN_FICHIER;
+    }
+    if (infos.st_size > 0) {
+        texte = mmap(NULL, (size_t)infos.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (texte == MAP_FAILED) {
+            close(fd);
+            return SOKOBAN_FICHIER;
+        }
+    }
+    close(fd);
+    ok = plateau_depuis_texte(plateau, texte, (size_t)infos.st_size);
+    if (infos.st_size > 0) {
+        munmap(texte, (size_t)infos.st_size);
+    }
+    if (!ok) {
+        return SOKOBAN_ERREUR_MEMOIRE;
+    }
+    return (joueur == NULL || trouver_joueur(plateau, joueur)) ?
+        SOKOBAN_OK : SOKOBAN_INVALIDE;
+}
+
+
+/**
+* @brief Charge un niveau .sok de taille quelconque (voir lire_niveau()) ;
+* arrête le programme si le fichier est illisible
+* @param plateau de type *t_plateau : le plateau (l'ancien contenu est libéré)
+* @param fichier de type char : le nom du fichier
+* @param joueur de type *int : reçoit la case du joueur, qui est alors
+* exigée (NULL pour ne pas la chercher)
+* @return false, après l'avoir affiché, si le niveau n'a pas de joueur
+*/
+bool charger_partie(t_plateau *plateau, char fichier[], int *joueur){
+    int res = lire_niveau(plateau, fichier, joueur);
+
+    if (res == SOKOBAN_FICHIER) {
         printf("ERREUR SUR FICHIER");
         exit(EXIT_FAILURE);
-    } else {
-        for (int ligne=0 ; ligne<TAILLE ; ligne++){
-            for (int colonne=0 ; colonne<TAILLE ; colonne++){
-                fread(&plateau[ligne][colonne], sizeof(char), 1, f);
-            }
-            fread(&finDeLigne, sizeof(char), 1, f);
-        }
-        fclose(f);
     }
+    if (res == SOKOBAN_INVALIDE) {
+        printf("niveau sans joueur : %s\n", fichier);
+        return false;
+    }
+    verifier_memoire(res == SOKOBAN_OK);
+    return true;
 }
 
 
-void enregistrer_partie(t_plateau plateau, char fichier[]){
+void enregistrer_partie(t_plateau *plateau, char fichier[]){
     FILE * f;
-    char finDeLigne='\n';
+    uint8_t *ligne;
 
     f = fopen(fichier, "w");
-    for (int ligne=0 ; ligne<TAILLE ; ligne++){
-        for (int colonne=0 ; colonne<TAILLE ; colonne++){
-            fwrite(&plateau[ligne][colonne], sizeof(char), 1, f);
+    for (int i=0 ; i<plateau->hauteur ; i++){
+        ligne = plateau->cases + plateau_indice(plateau, i, 0);
+        for (int j=0 ; j<plateau->largeur ; j++){
+            fputc(case_vers_car(ligne[j]), f);
         }
-        fwrite(&finDeLigne, sizeof(char), 1, f);
+        fputc('\n', f);
     }
     fclose(f);
 }
 
 
-int kbhit(){
-	// la fonction retourne :
-	// 1 si un caractere est present
-	// 0 si pas de caractere présent
-	int unCaractere=0;
-	struct termios oldt, newt;
-	int ch;
-	int oldf;
+/* Gestion du terminal : le mode brut n'est activé qu'une fois par partie,
+ * et l'attente d'une touche se fait en bloquant dans poll() plutôt qu'en
+ * interrogeant le clavier en boucle. */
+static struct termios terminalInitial;
+static volatile sig_atomic_t terminalSauve = 0;
+static volatile sig_atomic_t terminalBrut = 0;
+static volatile sig_atomic_t terminalRedimensionne = 0;
+#ifdef SOKOBAN_MESURES
+static volatile sig_atomic_t mesuresDemandees = 0;
+#endif
 
-	// mettre le terminal en mode non bloquant
-	tcgetattr(STDIN_FILENO, &oldt);
-	newt = oldt;
-	newt.c_lflag &= ~(ICANON | ECHO);
-	tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-	oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
-	fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
- 
-	ch = getchar();
+static void terminal_passer_brut();
+static void installer_signaux();
 
-	// restaurer le mode du terminal
-	tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-	fcntl(STDIN_FILENO, F_SETFL, oldf);
- 
-	if(ch != EOF){
-		ungetc(ch, stdin);
-		unCaractere=1;
-	} 
-	return unCaractere;
+
+/**
+* @brief Restaure le terminal puis laisse le signal produire son effet
+* @param sig de type int : le signal reçu (SIGINT, SIGTERM ou SIGTSTP)
+* Pour SIGTSTP, le mode brut est rétabli lorsque le processus reprend.
+*/
+static void gerer_signal(int sig) {
+    int sauveErrno = errno;
+    sigset_t masque;
+
+    terminal_restaurer();
+    signal(sig, SIG_DFL);
+    sigemptyset(&masque);
+    sigaddset(&masque, sig);
+    sigprocmask(SIG_UNBLOCK, &masque, NULL);
+    raise(sig);
+    // On n'arrive ici qu'après SIGCONT
+    installer_signaux();
+    terminal_passer_brut();
+    errno = sauveErrno;
 }
 
 
-void enregistrerDeplacements(t_tab_deplacement t, int nb, char fic[]){
-    FILE * f;
+/**
+* @brief Note le redimensionnement du terminal (SIGWINCH)
+* @param sig de type int : le signal reçu
+*/
+static void gerer_redimension(int sig) {
+    (void)sig;
+    terminalRedimensionne = 1;
+}
 
-    f = fopen(fic, "w");
-    fwrite(t,sizeof(char), nb, f);
-    fclose(f);
-}
\ No newline at end of file
+
+#ifdef SOKOBAN_MESURES
+/**
+* @brief Note une demande d'écriture des mesures (SIGUSR1)
+* @param sig de type int : le signal reçu
+*/
+static void gerer_demande_mesures(int sig) {
+    (void)sig;
+    mesuresDemandees = 1;
+}
+#endif
+
+
+/**
+* @brief Installe les gestionnaires de restauration et de redimensionnement
+* du terminal
+*/
+static void installer_signaux() {
+    struct sigaction action;
+    action.sa_handler = gerer_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGTSTP, &action, NULL);
+    action.sa_handler = gerer_redimension;
+    sigaction(SIGWINCH, &action, NULL);
+}
+
+
+/**
+* @brief Passe l'entrée standard en mode non canonique et sans écho
+*/
+static void terminal_passer_brut() {
+    struct termios brut;
+    if ( terminalSauve ) {
+        brut = terminalInitial;
+        brut.c_lflag &= ~(ICANON | ECHO);
+        brut.c_cc[VMIN] = 1;
+        brut.c_cc[VTIME] = 0;
+        if ( tcsetattr(STDIN_FILENO, TCSANOW, &brut) == 0 ) {
+            terminalBrut = 1;
+        }
+    }
+}
+
+
+/**
+* @brief Met le terminal en mode brut pour toute la durée de la partie
+* Le terminal est restauré à la sortie du programme ainsi que sur 
+* SIGINT, SIGTERM et SIGTSTP. Sans terminal (tube, fichier) rien n'est modifié.
+*/
+void terminal_init() {
+    if ( !terminalSauve ) {
+        if ( isatty(STDIN_FILENO) && 
+             tcgetattr(STDIN_FILENO, &terminalInitial) == 0 ) {
+            terminalSauve = 1;
+            atexit(terminal_restaurer);
+            installer_signaux();
+        }
+    }
+#ifdef SOKOBAN_MESURES
+    // même sans terminal (jeu piloté par un tube)
+    signal(SIGUSR1, gerer_demande_mesures);
+#endif
+    terminal_passer_brut();
+}
+
+
+/**
+* @brief Remet le terminal dans l'état trouvé au lancement
+*/
+void terminal_restaurer() {
+    if ( terminalSauve && terminalBrut ) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &terminalInitial);
+        terminalBrut = 0;
+    }
+}
+
+
+/**
+* @brief Quitte temporairement le mode brut (saisie d'une réponse au clavier)
+*/
+void terminal_suspendre() {
+    terminal_restaurer();
+}
+
+
+/**
+* @brief Revient en mode brut après terminal_suspendre()
+*/
+void terminal_reprendre() {
+    terminal_passer_brut();
+}
+
+
+/**
+* @brief Attend une touche en bloquant dans poll()
+* @param delaiMs de type int : délai maximal en millisecondes (DELAI_INFINI pour attendre indéfiniment)
+* @return le caractère lu, PAS_DE_TOUCHE si le délai a expiré, FIN_ENTREE
+* si l'entrée est fermée, REDIMENSION si le terminal a changé de taille
+*/
+int lire_touche(int delaiMs) {
+    struct pollfd pfd;
+    unsigned char c;
+    int res;
+    ssize_t n;
+
+    pfd.fd = STDIN_FILENO;
+    pfd.events = POLLIN;
+    for (;;) {
+        pfd.revents = 0;
+        res = poll(&pfd, 1, delaiMs);
+        MESURE_COMPTER(polls);
+        if ( terminalRedimensionne ) {
+            terminalRedimensionne = 0;
+            return REDIMENSION;
+        }
+#ifdef SOKOBAN_MESURES
+        if ( mesuresDemandees ) {
+            mesuresDemandees = 0;
+            return DEMANDE_MESURES;
+        }
+#endif
+        if ( res < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            return FIN_ENTREE;
+        }
+        if ( res == 0 ) {
+            return PAS_DE_TOUCHE;
+        }
+        n = read(STDIN_FILENO, &c, 1);
+        MESURE_COMPTER(lectures);
+        if ( n == 1 ) {
+            return c;
+        }
+        if ( n < 0 && (errno == EINTR || errno == EAGAIN) ) {
+            continue;
+        }
+        return FIN_ENTREE;
+    }
+}
+
+
+/**
+* @brief Enregistre les déplacements dans un journal binaire (voir t_journal)
+* @param t de type *t_tab_deplacement : l'historique des déplacements
+* @param plat de type *t_plateau : le plateau de jeu, pour l'identité du niveau
+* @param fic de type char : le nom du fichier
+*/
+void enregistrerDeplacements(t_tab_deplacement *t, t_plateau *plat, char fic[]){
+    t_journal j;
+
+    if (!journal_creer(&j, fic, plat->empreinte, plat->largeur, plat->hauteur)) {
+        printf("ERREUR SUR FICHIER");
+        return;
+    }
+    for (long k = 0; k < t->nb; k++) {
+        journal_ecrire(&j, depl_lire(t, k));
+    }
+    if (!journal_fermer(&j)) {
+        printf("ERREUR SUR FICHIER");
+    }
+}
+
+
+/**
+* @brief Enregistre les coups d'une partie dans un journal binaire (voir
+* t_journal) ; l'identité du niveau est l'empreinte de la position de
+* départ, la partie revient ensuite au coup où elle était
+* @param partie de type *t_sokoban : la partie
+* @param fic de type char : le nom du fichier
+* @return false si le fichier n'a pas pu être écrit
+*/
+bool enregistrer_coups(t_sokoban *partie, char fic[]) {
+    long n = sokoban_nb_coups(partie);
+    uint64_t empreinte;
+    t_journal j;
+
+    sokoban_aller(partie, 0);
+    empreinte = sokoban_empreinte(partie);
+    sokoban_aller(partie, n);
+    if (!journal_creer(&j, fic, empreinte, sokoban_largeur(partie),
+        sokoban_hauteur(partie))) {
+        return false;
+    }
+    for (long k = 0; k < n; k++) {
+        journal_ecrire(&j, sokoban_coup(partie, k));
+    }
+    return journal_fermer(&j);
+}
+
+
+// Journal de coups
+
+
+/**
+* @brief Prépare l'entête d'un journal dans un tampon
+* @param j de type *t_journal : le journal
+* @param entete de type *uint8_t : JOURNAL_ENTETE octets
+*/
+static void journal_entete(t_journal *j, uint8_t *entete) {
+    memcpy(entete, JOURNAL_MAGIE, 4);
+    ecrire_entier(entete + 4, JOURNAL_VERSION, 2);
+    ecrire_entier(entete + 6, (uint64_t)j->options, 2);
+    ecrire_entier(entete + 8, j->empreinte, 8);
+    ecrire_entier(entete + 16, j->largeur, 4);
+    ecrire_entier(entete + 20, j->hauteur, 4);
+    ecrire_entier(entete + JOURNAL_POS_NB, j->nbCoups, 8);
+}
+
+
+/**
+* @brief Vide le tampon d'écriture d'un journal dans son fichier
+* @param j de type *t_journal : le journal
+*/
+static void journal_vider(t_journal *j) {
+    fwrite(j->tampon, 1, j->taille, j->f);
+    j->taille = 0;
+}
+
+
+/**
+* @brief Ajoute un octet au tampon d'écriture d'un journal
+* @param j de type *t_journal : le journal
+* @param octet de type uint8_t : l'octet
+*/
+static void journal_octet(t_journal *j, uint8_t octet) {
+    if (j->taille == JOURNAL_TAMPON) {
+        journal_vider(j);
+    }
+    j->tampon[j->taille++] = octet;
+}
+
+
+/**
+* @brief Crée un journal en écriture ; le nombre de coups de l'entête est
+* fixé à la fermeture
+* @param j de type *t_journal : le journal
+* @param fic de type char : le nom du fichier
+* @param empreinte de type uint64_t : l'empreinte du niveau de départ
+* @param largeur de type int : la largeur du niveau
+* @param hauteur de type int : la hauteur du niveau
+* @return false si le fichier ne peut pas être créé
+*/
+bool journal_creer(t_journal *j, char fic[], uint64_t empreinte, int largeur,
+    int hauteur) {
+    uint8_t entete[JOURNAL_ENTETE];
+
+    j->f = fopen(fic, "wb");
+    if (j->f == NULL) {
+        return false;
+    }
+    j->ecriture = true;
+    j->options = JOURNAL_RLE;
+    j->empreinte = empreinte;
+    j->largeur = (uint32_t)largeur;
+    j->hauteur = (uint32_t)hauteur;
+    j->nbCoups = 0;
+    j->lus = 0;
+    j->courant = -1;
+    j->repetition = 0;
+    j->taille = 0;
+    j->pos = 0;
+    journal_entete(j, entete);
+    fwrite(entete, 1, JOURNAL_ENTETE, j->f);
+    return true;
+}
+
+
+/**
+* @brief Ajoute un coup à un journal en écriture
+* @param j de type *t_journal : le journal
+* @param coup de type int : le coup (direction et COUP_POUSSEE)
+*/
+void journal_ecrire(t_journal *j, int coup) {
+    coup &= (1 << DEPL_BITS) - 1;
+    j->nbCoups++;
+    if (coup == j->courant && j->repetition < JOURNAL_REPETITION_MAX) {
+        j->repetition++;
+        return;
+    }
+    if (j->courant >= 0) {
+        journal_octet(j, (uint8_t)(j->courant | (j->repetition - 1) << DEPL_BITS));
+    }
+    j->courant = coup;
+    j->repetition = 1;
+}
+
+
+/**
+* @brief Ouvre un journal en lecture et lit son entête
+* @param j de type *t_journal : le journal
+* @param fic de type char : le nom du fichier
+* @return false si le fichier est absent ou n'est pas un journal reconnu
+*/
+bool journal_ouvrir(t_journal *j, char fic[]) {
+    uint8_t entete[JOURNAL_ENTETE];
+
+    j->f = fopen(fic, "rb");
+    if (j->f == NULL) {
+        return false;
+    }
+    if (fread(entete, 1, JOURNAL_ENTETE, j->f) != JOURNAL_ENTETE ||
+        memcmp(entete, JOURNAL_MAGIE, 4) != 0 ||
+        lire_entier(entete + 4, 2) != JOURNAL_VERSION ||
+        lire_entier(entete + 6, 2) != JOURNAL_RLE) {
+        fclose(j->f);
+        return false;
+    }
+    j->ecriture = false;
+    j->options = (int)lire_entier(entete + 6, 2);
+    j->empreinte = lire_entier(entete + 8, 8);
+    j->largeur = (uint32_t)lire_entier(entete + 16, 4);
+    j->hauteur = (uint32_t)lire_entier(entete + 20, 4);
+    j->nbCoups = lire_entier(entete + JOURNAL_POS_NB, 8);
+    j->lus = 0;
+    j->courant = -1;
+    j->repetition = 0;
+    j->taille = 0;
+    j->pos = 0;
+    return true;
+}
+
+
+/**
+* @brief Lit le coup suivant d'un journal ouvert en lecture
+* @param j de type *t_journal : le journal
+* @return le coup, JOURNAL_FIN après le dernier coup, ou JOURNAL_ERREUR
+* si le fichier est tronqué
+*/
+int journal_lire(t_journal *j) {
+    uint8_t octet;
+
+    if (j->lus == j->nbCoups) {
+        return JOURNAL_FIN;
+    }
+    j->lus++;
+    if (j->repetition > 0) {
+        j->repetition--;
+        return j->courant;
+    }
+    if (j->pos == j->taille) {
+        j->taille = fread(j->tampon, 1, JOURNAL_TAMPON, j->f);
+        j->pos = 0;
+        if (j->taille == 0) {
+            return JOURNAL_ERREUR;
+        }
+    }
+    octet = j->tampon[j->pos++];
+    j->courant = octet & ((1 << DEPL_BITS) - 1);
+    j->repetition = octet >> DEPL_BITS;
+    return j->courant;
+}
+
+
+/**
+* @brief Ferme un journal ; en écriture, vide le tampon et inscrit le
+* nombre de coups dans l'entête
+* @param j de type *t_journal : le journal
+* @return false si l'écriture a échoué
+*/
+bool journal_fermer(t_journal *j) {
+    bool ok = true;
+
+    if (j->ecriture) {
+        uint8_t nb[8];
+        if (j->courant >= 0) {
+            journal_octet(j, (uint8_t)(j->courant | (j->repetition - 1) << DEPL_BITS));
+        }
+        journal_vider(j);
+        ecrire_entier(nb, j->nbCoups, 8);
+        ok = fseek(j->f, JOURNAL_POS_NB, SEEK_SET) == 0 && 
+            fwrite(nb, 1, 8, j->f) == 8;
+        ok = !ferror(j->f) && ok;
+    }
+    return (fclose(j->f) == 0) && ok;
+}
+
+
+/**
+* @brief Donne la lettre de la notation LURD d'un coup (minuscule pour
+* une marche, majuscule pour une poussée)
+* @param coup de type int : le coup
+* @return la lettre
+*/
+char coup_vers_lurd(int coup) {
+    static const char lurd[8] = { 'u', 'd', 'l', 'r', 'U', 'D', 'L', 'R' };
+    return lurd[coup & 7];
+}
+
+
+/**
+* @brief Donne le coup d'une lettre de la notation LURD
+* @param lurd de type char : la lettre
+* @return le coup, ou -1 si la lettre est inconnue
+*/
+int lurd_vers_coup(char lurd) {
+    int coup = -1;
+    switch (lurd) {
+        case 'u': coup = DIR_HAUT; break;
+        case 'd': coup = DIR_BAS; break;
+        case 'l': coup = DIR_GAUCHE; break;
+        case 'r': coup = DIR_DROITE; break;
+        case 'U': coup = DIR_HAUT | COUP_POUSSEE; break;
+        case 'D': coup = DIR_BAS | COUP_POUSSEE; break;
+        case 'L': coup = DIR_GAUCHE | COUP_POUSSEE; break;
+        case 'R': coup = DIR_DROITE | COUP_POUSSEE; break;
+    }
+    return coup;
+}
+
+
+/**
+* @brief Mode --export-lurd : écrit un journal en notation LURD
+* @param journal de type char : le journal binaire
+* @param sortie de type char : le fichier texte à écrire
+* @return 0 si la conversion a réussi, 1 sinon
+*/
+int exporter_lurd(char journal[], char sortie[]) {
+    t_journal j;
+    FILE *f;
+    int coup;
+
+    if (!journal_ouvrir(&j, journal)) {
+        printf("journal illisible : %s\n", journal);
+        return 1;
+    }
+    f = fopen(sortie, "w");
+    if (f == NULL) {
+        journal_fermer(&j);
+        printf("ERREUR SUR FICHIER");
+        return 1;
+    }
+    while ((coup = journal_lire(&j)) >= 0) {
+        putc(coup_vers_lurd(coup), f);
+    }
+    putc('\n', f);
+    fclose(f);
+    journal_fermer(&j);
+    if (coup == JOURNAL_ERREUR) {
+        printf("journal tronqué : %s\n", journal);
+        return 1;
+    }
+    printf("%llu coups exportés\n", (unsigned long long)j.nbCoups);
+    return 0;
+}
+
+
+/**
+* @brief Mode --import-lurd : convertit un texte LURD en journal binaire
+* pour un niveau donné (les blancs sont ignorés)
+* @param niveau de type char : le niveau .sok joué
+* @param texte de type char : le fichier LURD
+* @param journal de type char : le journal binaire à écrire
+* @return 0 si la conversion a réussi, 1 sinon
+*/
+int importer_lurd(char niveau[], char texte[], char journal[]) {
+    t_plateau plat;
+    t_journal j;
+    FILE *f;
+    int c;
+    int res = 0;
+
+    f = fopen(texte, "r");
+    if (f == NULL) {
+        printf("ERREUR SUR FICHIER");
+        return 1;
+    }
+    plat.cases = NULL;
+    charger_partie(&plat, niveau, NULL);
+    if (!journal_creer(&j, journal, plat.empreinte, plat.largeur, plat.hauteur)) {
+        fclose(f);
+        plateau_liberer(&plat);
+        printf("ERREUR SUR FICHIER");
+        return 1;
+    }
+    while ((c = getc(f)) != EOF && res == 0) {
+        int coup = lurd_vers_coup((char)c);
+        if (coup >= 0) {
+            journal_ecrire(&j, coup);
+        } else if (c != '\n' && c != '\r' && c != VIDE && c != '\t') {
+            printf("caractère LURD inconnu : '%c'\n", c);
+            res = 1;
+        }
+    }
+    if (!journal_fermer(&j)) {
+        res = 1;
+    }
+    if (res == 0) {
+        printf("%llu coups importés\n", (unsigned long long)j.nbCoups);
+    }
+    fclose(f);
+    plateau_liberer(&plat);
+    return res;
+}
+
+
+// Sauvegarde de partie
+
+
+/**
+* @brief Enregistre une partie complète dans un seul fichier (voir
+* sokoban_serialiser() pour le format)
+* @param fichier de type char : le nom du fichier
+* @param partie de type *t_sokoban : la partie
+* @return false si l'écriture a échoué
+*/
+bool sauver_partie(char fichier[], t_sokoban *partie) {
+    size_t taille = sokoban_serialiser(partie, NULL, 0);
+    uint8_t *donnees = malloc(taille);
+    FILE *f;
+    bool ok;
+
+    verifier_memoire(donnees != NULL);
+    sokoban_serialiser(partie, donnees, taille);
+    f = fopen(fichier, "wb");
+    ok = f != NULL && fwrite(donnees, 1, taille, f) == taille;
+    ok = (f != NULL && fclose(f) == 0) && ok;
+    free(donnees);
+    return ok;
+}
+
+
+/**
+* @brief Ouvre un niveau .sok, ou reprend une partie enregistrée par
+* sauver_partie() là où elle s'était arrêtée (voir sokoban_ouvrir())
+* @param fichier de type char : le nom du fichier
+* @return la partie, ou NULL après avoir affiché l'erreur
+*/
+t_sokoban *ouvrir_partie(char fichier[]) {
+    int erreur;
+    t_sokoban *partie = sokoban_ouvrir(fichier, &erreur);
+
+    switch (erreur) {
+        case SOKOBAN_FICHIER:
+            printf("ERREUR SUR FICHIER");
+            break;
+        case SOKOBAN_INVALIDE:
+            printf("niveau ou sauvegarde invalide : %s\n", fichier);
+            break;
+        case SOKOBAN_ERREUR_MEMOIRE:
+            printf("ERREUR MEMOIRE");
+            break;
+    }
+    return partie;
+}
+
+
+// Banc d'essai du moteur
+
+
+/**
+* @brief Déplacement avec l'ancien codage des cases en caractères,
+* conservé uniquement comme référence pour bench_moteur()
+*/
+static int bench_jouer_car(char *cases, int *voisin, int *joueur, int *cibles,
+    int dir) {
+    int decalage = voisin[dir];
+    int suivant = *joueur + decalage;
+    char caseSuivante = cases[suivant];
+    int coup = dir;
+
+    if (caseSuivante == MUR) {
+        return -1;
+    }
+    if (caseSuivante == CAISSE || caseSuivante == CAISSE_CIBLE) {
+        int dest = suivant + decalage;
+        if (cases[dest] == VIDE) {
+            cases[dest] = CAISSE;
+        } else if (cases[dest] == CIBLE) {
+            cases[dest] = CAISSE_CIBLE;
+            (*cibles)--;
+        } else {
+            return -1;
+        }
+        coup |= COUP_POUSSEE;
+    }
+    if (cases[*joueur] == SOKOBAN_CIBLE) {
+        cases[*joueur] = CIBLE;
+    } else {
+        cases[*joueur] = VIDE;
+    }
+    if (caseSuivante == CAISSE_CIBLE) {
+        (*cibles)++;
+    }
+    if (caseSuivante == CIBLE || caseSuivante == CAISSE_CIBLE) {
+        cases[suivant] = SOKOBAN_CIBLE;
+    } else {
+        cases[suivant] = SOKOBAN;
+    }
+    *joueur = suivant;
+    return coup;
+}
+
+
+/**
+* @brief Annulation avec l'ancien codage des cases en caractères
+*/
+static void bench_annuler_car(char *cases, int *voisin, int *joueur, 
+    int *cibles, int coup) {
+    int decalage = voisin[coup & 3];
+    int pos = *joueur;
+    int precedent = pos - decalage;
+
+    if (coup & COUP_POUSSEE) {
+        int caisse = pos + decalage;
+        if (cases[caisse] == CAISSE_CIBLE) {
+            cases[caisse] = CIBLE;
+            (*cibles)++;
+        } else {
+            cases[caisse] = VIDE;
+        }
+        if (cases[pos] == SOKOBAN_CIBLE) {
+            cases[pos] = CAISSE_CIBLE;
+            (*cibles)--;
+        } else {
+            cases[pos] = CAISSE;
+        }
+    } else {
+        if (cases[pos] == SOKOBAN_CIBLE) {
+            cases[pos] = CIBLE;
+        } else {
+            cases[pos] = VIDE;
+        }
+    }
+    if (cases[precedent] == CIBLE) {
+        cases[precedent] = SOKOBAN_CIBLE;
+    } else {
+        cases[precedent] = SOKOBAN;
+    }
+    *joueur = precedent;
+}
+
+
+/**
+* @brief Donne le temps écoulé en secondes depuis une origine arbitraire
+* @return le temps en secondes
+*/
+static double bench_horloge() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+
+/**
+* @brief Compare les coups par seconde des codages de cases
+* @param fichier de type char : le niveau .sok utilisé
+* @param coups de type long : le nombre de touches simulées
+* @return 0 si tous les codages aboutissent au même plateau, 1 sinon
+* La même suite pseudo-aléatoire de déplacements et d'annulations
+* (une touche sur quatre) est jouée sur les caractères, les bits
+* par case et les bitboards, avec un test de victoire après chaque coup.
+*/
+int bench_moteur(char fichier[], long coups) {
+    t_plateau plat;
+    t_tab_deplacement depl;
+    t_bitboard bb;
+    t_plateau verif;
+    char *cases;
+    uint8_t *dirs;
+    size_t total;
+    int joueur = -1, joueurCar, ciblesCar;
+    unsigned graine = 12345;
+    double debut, tempsBits, tempsCar, tempsBb;
+    long joues, gagnesCar = 0, gagnesBits = 0, gagnesBb = 0;
+    bool identiques = true;
+
+    plat.cases = NULL;
+    if (!charger_partie(&plat, fichier, &joueur)) {
+        plateau_liberer(&plat);
+        return 1;
+    }
+    total = (size_t)(plat.hauteur + 2 * BORDURE) * (size_t)plat.pas;
+
+    // copie du plateau avec l'ancien codage
+    cases = malloc(total);
+    dirs = malloc((size_t)coups);
+    if (cases == NULL || dirs == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k < total; k++) {
+        cases[k] = case_vers_car(plat.cases[k]);
+    }
+    // 0 à 3 : direction, 4 : annulation
+    for (long k = 0; k < coups; k++) {
+        graine = graine * 1103515245u + 12345u;
+        dirs[k] = (uint8_t)((graine >> 16) % 16);
+        dirs[k] = (dirs[k] < 12) ? dirs[k] % 4 : 4;
+    }
+    joueurCar = joueur;
+    ciblesCar = plat.cibles;
+    bitboard_depuis_plateau(&bb, &plat, joueur);
+
+    depl_init(&depl);
+    joues = 0;
+    debut = bench_horloge();
+    for (long k = 0; k < coups; k++) {
+        if (dirs[k] == 4) {
+            if (depl.nb > 0) {
+                bench_annuler_car(cases, plat.voisin, &joueurCar, &ciblesCar,
+                    depl_retirer(&depl));
+            }
+        } else {
+            int coup = bench_jouer_car(cases, plat.voisin, &joueurCar, 
+                &ciblesCar, dirs[k]);
+            if (coup >= 0) {
+                verifier_memoire(depl_ajouter(&depl, coup));
+                joues++;
+            }
+            gagnesCar += (ciblesCar == 0);
+        }
+    }
+    tempsCar = bench_horloge() - debut;
+
+    depl_vider(&depl);
+    debut = bench_horloge();
+    for (long k = 0; k < coups; k++) {
+        if (dirs[k] == 4) {
+            if (depl.nb > 0) {
+                annuler_coup(&plat, &joueur, depl_retirer(&depl));
+            }
+        } else {
+            int coup = jouer_coup(&plat, &joueur, dirs[k]);
+            if (coup >= 0) {
+                verifier_memoire(depl_ajouter(&depl, coup));
+            }
+            gagnesBits += gagne(&plat);
+        }
+    }
+    tempsBits = bench_horloge() - debut;
+
+    depl_vider(&depl);
+    debut = bench_horloge();
+    for (long k = 0; k < coups; k++) {
+        if (dirs[k] == 4) {
+            if (depl.nb > 0) {
+                bitboard_annuler(&bb, depl_retirer(&depl));
+            }
+        } else {
+            int coup = bitboard_jouer(&bb, dirs[k]);
+            if (coup >= 0) {
+                verifier_memoire(depl_ajouter(&depl, coup));
+            }
+            gagnesBb += bitboard_gagne(&bb);
+        }
+    }
+    tempsBb = bench_horloge() - debut;
+    verifier_memoire(plateau_init(&verif, plat.largeur, plat.hauteur));
+    bitboard_vers_plateau(&bb, &verif);
+    // cases mortes et compteurs d'impasses
+    verifier_memoire(analyser_niveau(&verif));
+
+    for (size_t k = 0; k < total; k++) {
+        if (cases[k] != case_vers_car(plat.cases[k])) {
+            identiques = false;
+        }
+    }
+    identiques = identiques && (joueur == joueurCar) && (plat.cibles == ciblesCar);
+    identiques = identiques && (bb.joueur == joueur) && (verif.cibles == plat.cibles)
+        && memcmp(verif.cases, plat.cases, total) == 0 
+        && (verif.mortes == plat.mortes) && (verif.figes == plat.figes)
+        && (gagnesCar == gagnesBits) && (gagnesBits == gagnesBb);
+
+    printf("niveau : %s (%dx%d), %ld touches, %ld coups valides\n", fichier,
+        plat.largeur, plat.hauteur, coups, joues);
+    printf("caracteres : %.3f s, %.1f Mcoups/s\n", tempsCar, 
+        coups / tempsCar / 1e6);
+    printf("bits       : %.3f s, %.1f Mcoups/s (x%.2f)\n", tempsBits,
+        coups / tempsBits / 1e6, tempsCar / tempsBits);
+    printf("bitboards  : %.3f s, %.1f Mcoups/s (x%.2f)\n", tempsBb,
+        coups / tempsBb / 1e6, tempsCar / tempsBb);
+    printf("plateaux identiques : %s\n", identiques ? "oui" : "NON");
+
+    free(cases);
+    free(dirs);
+    depl_liberer(&depl);
+    plateau_liberer(&plat);
+    plateau_liberer(&verif);
+    bitboard_liberer(&bb);
+    return identiques ? 0 : 1;
+}
+
+
+// Recueils de niveaux
+
+
+/**
+* @brief Indique si une ligne d'un recueil appartient à un plateau : elle
+* n'a que des caractères du format .sok (ou '-' et '_' pour le sol) et
+* au moins un mur
+* @param ligne de type *char : la ligne
+* @param longueur de type int : sa longueur utile
+* @return true pour une ligne de plateau
+*/
+static bool ligne_de_plateau(const char *ligne, int longueur) {
+    bool mur = false;
+    for (int k = 0; k < longueur; k++) {
+        switch (ligne[k]) {
+            case MUR:
+                mur = true;
+                break;
+            case VIDE: case SOKOBAN: case SOKOBAN_CIBLE: case CIBLE:
+            case CAISSE: case CAISSE_CIBLE: case '-': case '_': case '\t':
+                break;
+            default:
+                return false;
+        }
+    }
+    return mur;
+}
+
+
+/**
+* @brief Projette un index enregistré s'il correspond encore au recueil ;
+* un index dont une entrée sort du recueil est refusé (il sera reconstruit)
+* @param pack de type *t_pack : le recueil, déjà projeté
+* @param nomIndex de type char : le fichier d'index
+* @param date de type uint64_t : la date de modification du recueil
+* @return true si l'index est utilisable
+*/
+static bool pack_charger_index(t_pack *pack, char nomIndex[], uint64_t date) {
+    struct stat infos;
+    uint8_t *index;
+    int fd = open(nomIndex, O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &infos) != 0 || infos.st_size < PACK_ENTETE) {
+        close(fd);
+        return false;
+    }
+    index = mmap(NULL, (size_t)infos.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (index == MAP_FAILED) {
+        return false;
+    }
+    uint64_t nb = lire_entier(index + 24, 8);
+    bool valide = memcmp(index, PACK_MAGIE, 4) == 0 &&
+        lire_entier(index + 4, 4) == PACK_VERSION &&
+        lire_entier(index + 8, 8) == pack->taille &&
+        lire_entier(index + 16, 8) == date &&
+        nb <= ((size_t)infos.st_size - PACK_ENTETE) / PACK_ENTREE &&
+        (size_t)infos.st_size == PACK_ENTETE + nb * PACK_ENTREE;
+    for (uint64_t k = 0; valide && k < nb; k++) {
+        const uint8_t *entree = index + PACK_ENTETE + k * PACK_ENTREE;
+        uint64_t position = lire_entier(entree, 8);
+        valide = position <= pack->taille &&
+            lire_entier(entree + 8, 4) <= pack->taille - position;
+    }
+    if (!valide) {
+        munmap(index, (size_t)infos.st_size);
+        return false;
+    }
+    pack->index = index;
+    pack->tailleIndex = (size_t)infos.st_size;
+    pack->indexProjete = true;
+    pack->nbNiveaux = (long)nb;
+    return true;
+}
+
+
+/**
+* @brief Construit l'index d'un recueil en une lecture et tente de
+* l'enregistrer à côté du recueil, sauf pour un fichier d'un seul niveau
+* où le reconstruire ne coûte rien
+* @param pack de type *t_pack : le recueil, déjà projeté
+* @param nomIndex de type char : le fichier d'index à écrire
+* @param date de type uint64_t : la date de modification du recueil
+*/
+static void pack_construire_index(t_pack *pack, char nomIndex[], uint64_t date) {
+    size_t capacite = PACK_ENTETE + 64 * PACK_ENTREE;
+    size_t debut = 0, debutNiveau = 0, finNiveau = 0;
+    bool dansNiveau = false;
+    long nb = 0;
+    FILE *f;
+
+    pack->index = malloc(capacite);
+    if (pack->index == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k <= pack->taille; k++) {
+        if (k < pack->taille && pack->donnees[k] != '\n') {
+            continue;
+        }
+        int longueur = longueur_utile(pack->donnees + debut, k - debut);
+        bool plateau = ligne_de_plateau(pack->donnees + debut, longueur);
+        if (plateau && !dansNiveau) {
+            debutNiveau = debut;
+        }
+        if (plateau) {
+            finNiveau = debut + (size_t)longueur;
+        }
+        if (dansNiveau && (!plateau || k == pack->taille)) {
+            if (PACK_ENTETE + (size_t)(nb + 1) * PACK_ENTREE > capacite) {
+                capacite *= 2;
+                pack->index = realloc(pack->index, capacite);
+                if (pack->index == NULL) {
+                    printf("ERREUR MEMOIRE");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            uint8_t *entree = pack->index + PACK_ENTETE + (size_t)nb * PACK_ENTREE;
+            ecrire_entier(entree, debutNiveau, 8);
+            ecrire_entier(entree + 8, finNiveau - debutNiveau, 4);
+            nb++;
+        }
+        dansNiveau = plateau;
+        debut = k + 1;
+    }
+    memcpy(pack->index, PACK_MAGIE, 4);
+    ecrire_entier(pack->index + 4, PACK_VERSION, 4);
+    ecrire_entier(pack->index + 8, pack->taille, 8);
+    ecrire_entier(pack->index + 16, date, 8);
+    ecrire_entier(pack->index + 24, (uint64_t)nb, 8);
+    pack->tailleIndex = PACK_ENTETE + (size_t)nb * PACK_ENTREE;
+    pack->indexProjete = false;
+    pack->nbNiveaux = nb;
+
+    // un recueil en lecture seule reste utilisable sans index enregistré
+    f = (nb > 1) ? fopen(nomIndex, "wb") : NULL;
+    if (f != NULL) {
+        fwrite(pack->index, 1, pack->tailleIndex, f);
+        fclose(f);
+    }
+}
+
+
+/**
+* @brief Ouvre un recueil de niveaux : le projette en mémoire et charge
+* son index, ou le construit s'il est absent ou périmé
+* @param pack de type *t_pack : le recueil
+* @param fichier de type char : le nom du recueil
+* @param construit de type *bool : reçoit true si l'index a été construit
+* @return false si le recueil ne peut pas être ouvert
+*/
+bool pack_ouvrir(t_pack *pack, char fichier[], bool *construit) {
+    struct stat infos;
+    char *nomIndex;
+    uint64_t date;
+    int fd = open(fichier, O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &infos) != 0) {
+        close(fd);
+        return false;
+    }
+    pack->taille = (size_t)infos.st_size;
+    pack->donnees = "";
+    if (pack->taille > 0) {
+        pack->donnees = mmap(NULL, pack->taille, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pack->donnees == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+    }
+    close(fd);
+    date = (uint64_t)infos.st_mtime;
+
+    nomIndex = malloc(strlen(fichier) + sizeof(PACK_SUFFIXE));
+    if (nomIndex == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(nomIndex, fichier);
+    strcat(nomIndex, PACK_SUFFIXE);
+    *construit = !pack_charger_index(pack, nomIndex, date);
+    if (*construit) {
+        pack_construire_index(pack, nomIndex, date);
+    }
+    free(nomIndex);
+    return true;
+}
+
+
+/**
+* @brief Trouve le texte du niveau numéro N d'un recueil, sans lire les
+* précédents
+* @param pack de type *t_pack : le recueil ouvert
+* @param numero de type long : le numéro du niveau, à partir de 1
+* @param texte de type **char : reçoit le début du texte, dans le recueil
+* @param taille de type *size_t : reçoit sa longueur
+* @return false si le numéro n'existe pas
+*/
+bool pack_texte(t_pack *pack, long numero, const char **texte, size_t *taille) {
+    const uint8_t *entree;
+
+    if (numero < 1 || numero > pack->nbNiveaux) {
+        return false;
+    }
+    entree = pack->index + PACK_ENTETE + (size_t)(numero - 1) * PACK_ENTREE;
+    *texte = pack->donnees + lire_entier(entree, 8);
+    *taille = (size_t)lire_entier(entree + 8, 4);
+    return true;
+}
+
+
+/**
+* @brief Charge le niveau numéro N d'un recueil, sans lire les précédents
+* @param pack de type *t_pack : le recueil ouvert
+* @param numero de type long : le numéro du niveau, à partir de 1
+* @param plat de type *t_plateau : le plateau (l'ancien contenu est libéré)
+* @return false si le numéro n'existe pas
+*/
+bool pack_niveau(t_pack *pack, long numero, t_plateau *plat) {
+    const char *texte;
+    size_t taille;
+
+    if (!pack_texte(pack, numero, &texte, &taille)) {
+        return false;
+    }
+    verifier_memoire(plateau_depuis_texte(plat, texte, taille));
+    return true;
+}
+
+
+/**
+* @brief Ferme un recueil de niveaux
+* @param pack de type *t_pack : le recueil
+*/
+void pack_fermer(t_pack *pack) {
+    if (pack->taille > 0) {
+        munmap(pack->donnees, pack->taille);
+    }
+    if (pack->indexProjete) {
+        munmap(pack->index, pack->tailleIndex);
+    } else {
+        free(pack->index);
+    }
+}
+
+
+/**
+* @brief Mode --pack-info : ouvre un recueil et affiche son nombre de
+* niveaux et le temps d'ouverture
+* @param fichier de type char : le recueil
+* @return 0 si le recueil a pu être ouvert, 1 sinon
+*/
+int infos_pack(char fichier[]) {
+    t_pack pack;
+    bool construit;
+    double debut = bench_horloge();
+
+    if (!pack_ouvrir(&pack, fichier, &construit)) {
+        printf("ERREUR SUR FICHIER");
+        return 1;
+    }
+    printf("%s : %ld niveaux, index %s en %.3f ms\n", fichier, pack.nbNiveaux,
+        construit ? "construit" : "chargé", (bench_horloge() - debut) * 1000);
+    pack_fermer(&pack);
+    return 0;
+}
+
+
+/**
+* @brief Mode --dedup : ajoute les niveaux des recueils à un index de clés
+* canoniques et affiche ceux qui y étaient déjà (un fichier .sok est un
+* recueil d'un seul niveau)
+* @param index de type char : le fichier d'index, créé s'il n'existe pas
+* @param recueils de type *char[] : les recueils
+* @param nb de type int : le nombre de recueils
+* @return 0 si tous les recueils ont pu être lus, 1 sinon
+*/
+int dedoublonner(char index[], char *recueils[], int nb) {
+    t_sokoban_index *idx;
+    t_pack pack;
+    t_plateau plat;
+    bool construit;
+    long niveaux = 0, doublons = 0;
+    int erreur, res = 0;
+    double debut = bench_horloge(), duree;
+
+    idx = sokoban_index_ouvrir(index, &erreur);
+    if (idx == NULL) {
+        printf("index illisible : %s (%d)\n", index, erreur);
+        return 1;
+    }
+    plat.cases = NULL;
+    for (int f = 0; f < nb; f++) {
+        if (!pack_ouvrir(&pack, recueils[f], &construit)) {
+            printf("ERREUR SUR FICHIER : %s\n", recueils[f]);
+            res = 1;
+            continue;
+        }
+        for (long n = 1; n <= pack.nbNiveaux; n++) {
+            uint64_t cle[2];
+            int joueur;
+            // un niveau sans joueur a aussi une clé (voir cle_canonique())
+            pack_niveau(&pack, n, &plat);
+            trouver_joueur(&plat, &joueur);
+            verifier_memoire(cle_canonique(&plat, joueur, cle));
+            erreur = sokoban_index_ajouter(idx, cle);
+            verifier_memoire(erreur >= 0);
+            if (erreur == 0) {
+                printf("%s niveau %ld : doublon\n", recueils[f], n);
+                doublons++;
+            }
+            niveaux++;
+        }
+        pack_fermer(&pack);
+    }
+    duree = bench_horloge() - debut;
+    printf("%ld niveaux, %ld nouveaux, %ld doublons, index de %ld niveaux, "
+        "%.3f s (%.0f niveaux/s)\n", niveaux, niveaux - doublons, doublons, 
+        sokoban_index_nombre(idx), duree, 
+        (duree > 0) ? (double)niveaux / duree : 0.0);
+    plateau_liberer(&plat);
+    sokoban_index_fermer(idx);
+    return res;
+}
+
+
+// Solveur
+
+
+/**
+* @brief Tire le nombre pseudo-aléatoire suivant (splitmix64)
+* @param etat de type *uint64_t : l'état du générateur (mis à jour)
+* @return un entier de 64 bits
+*/
+static uint64_t aleatoire64(uint64_t *etat) {
+    uint64_t z = (*etat += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+
+/**
+* @brief Prépare les données d'un niveau pour la recherche
+* @param niv de type *t_niveau_sol : les données à remplir
+* @param plat de type *t_plateau : le plateau de départ
+* @param joueur de type int : la case du joueur
+* @return true si le niveau peut être traité par le solveur
+*/
+bool solveur_preparer(t_niveau_sol *niv, t_plateau *plat, int joueur) {
+    uint64_t graine = 0x5EED5EED12345678ull;
+    uint16_t *file;
+    int debut, fin;
+
+    niv->total = (plat->hauteur + 2 * BORDURE) * plat->pas;
+    if (niv->total > SOL_CASES_MAX) {
+        return false;
+    }
+    for (int d = 0; d < NB_DIRECTIONS; d++) {
+        niv->voisin[d] = plat->voisin[d];
+    }
+    niv->murs = malloc((size_t)niv->total);
+    niv->cibles = malloc((size_t)niv->total);
+    niv->distance = malloc((size_t)niv->total * sizeof(uint16_t));
+    niv->zCaisse = malloc((size_t)niv->total * 2 * sizeof(uint64_t));
+    niv->caissesDepart = malloc((size_t)niv->total * sizeof(uint16_t));
+    file = malloc((size_t)niv->total * sizeof(uint16_t));
+    if (niv->murs == NULL || niv->cibles == NULL || niv->distance == NULL ||
+        niv->zCaisse == NULL || niv->caissesDepart == NULL || file == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    niv->zJoueur = niv->zCaisse + niv->total;
+    niv->nbCaisses = 0;
+    niv->ciblesLibres = plat->cibles;
+    niv->joueurDepart = joueur;
+    niv->perdu = en_impasse(plat);
+    for (int k = 0; k < niv->total; k++) {
+        uint8_t c = plat->cases[k];
+        niv->murs[k] = (c & CASE_MUR) != 0;
+        niv->cibles[k] = (c & CASE_CIBLE) != 0;
+        niv->distance[k] = SOL_INFINI;
+        niv->zCaisse[k] = aleatoire64(&graine);
+        niv->zJoueur[k] = aleatoire64(&graine);
+        if (c & CASE_CAISSE) {
+            niv->caissesDepart[niv->nbCaisses++] = (uint16_t)k;
+        }
+    }
+
+    // Distance de chaque case à la cible la plus proche, en ignorant
+    // les autres caisses : minorant du nombre de poussées
+    debut = 0;
+    fin = 0;
+    for (int k = 0; k < niv->total; k++) {
+        if (niv->cibles[k]) {
+            niv->distance[k] = 0;
+            file[fin++] = (uint16_t)k;
+        }
+    }
+    while (debut < fin) {
+        int k = file[debut++];
+        for (int d = 0; d < NB_DIRECTIONS; d++) {
+            int v = k + niv->voisin[d];
+            if (!niv->murs[v] && niv->distance[v] == SOL_INFINI) {
+                niv->distance[v] = (uint16_t)(niv->distance[k] + 1);
+                file[fin++] = (uint16_t)v;
+            }
+        }
+    }
+    // une caisse ne doit jamais être poussée sur une case morte
+    for (int k = 0; k < niv->total; k++) {
+        if (plat->cases[k] & CASE_MORTE) {
+            niv->distance[k] = SOL_INFINI;
+        }
+    }
+    free(file);
+    return true;
+}
+
+
+/**
+* @brief Libère les données d'un niveau préparé
+* @param niv de type *t_niveau_sol : les données du niveau
+*/
+void solveur_liberer(t_niveau_sol *niv) {
+    free(niv->murs);
+    free(niv->cibles);
+    free(niv->distance);
+    free(niv->zCaisse);
+    free(niv->caissesDepart);
+}
+
+
+/**
+* @brief Alloue les tableaux de travail d'une recherche
+* @param trav de type *t_travail_sol : les tableaux de travail
+* @param niv de type *t_niveau_sol : les données du niveau
+*/
+static void travail_init(t_travail_sol *trav, t_niveau_sol *niv) {
+    trav->occupe = calloc((size_t)niv->total, 1);
+    trav->vu = calloc((size_t)niv->total, sizeof(uint32_t));
+    trav->vuFils = calloc((size_t)niv->total, sizeof(uint32_t));
+    trav->file = malloc((size_t)niv->total * sizeof(uint16_t));
+    trav->venu = malloc((size_t)niv->total);
+    if (trav->occupe == NULL || trav->vu == NULL || trav->vuFils == NULL ||
+        trav->file == NULL || trav->venu == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    trav->generation = 0;
+}
+
+
+/**
+* @brief Libère les tableaux de travail d'une recherche
+* @param trav de type *t_travail_sol : les tableaux de travail
+*/
+static void travail_liberer(t_travail_sol *trav) {
+    free(trav->occupe);
+    free(trav->vu);
+    free(trav->vuFils);
+    free(trav->file);
+    free(trav->venu);
+}
+
+
+/**
+* @brief Parcourt en largeur les cases accessibles au joueur sans pousser
+* @param niv de type *t_niveau_sol : les données du niveau
+* @param trav de type *t_travail_sol : les tableaux de travail (occupe
+* doit contenir les caisses)
+* @param depart de type int : la case du joueur
+* @param vu de type *uint32_t : les cases atteintes y sont marquées du
+* numéro de parcours trav->generation, ce qui évite d'effacer le tableau
+* @return la plus petite case accessible, qui représente la zone du joueur
+*/
+static int zone_joueur(t_niveau_sol *niv, t_travail_sol *trav, int depart,
+    uint32_t *vu) {
+    int debut = 0, fin = 0;
+    int mini = depart;
+    uint32_t gen = ++trav->generation;
+
+    vu[depart] = gen;
+    trav->file[fin++] = (uint16_t)depart;
+    while (debut < fin) {
+        int k = trav->file[debut++];
+        if (k < mini) {
+            mini = k;
+        }
+        for (int d = 0; d < NB_DIRECTIONS; d++) {
+            int v = k + niv->voisin[d];
+            if (vu[v] != gen && !niv->murs[v] && !trav->occupe[v]) {
+                vu[v] = gen;
+                trav->venu[v] = (uint8_t)d;
+                trav->file[fin++] = (uint16_t)v;
+            }
+        }
+    }
+    return mini;
+}
+
+
+/**
+* @brief Teste si une caisse qui vient d'être poussée est bloquée dans un
+* carré 2x2 de murs et de caisses, dont une au moins hors cible
+* @param niv de type *t_niveau_sol : les données du niveau
+* @param trav de type *t_travail_sol : les tableaux de travail (occupe
+* contient les caisses après la poussée)
+* @param caisse de type int : la nouvelle case de la caisse
+* @return true si l'état est une impasse
+*/
+static bool solveur_fige(t_niveau_sol *niv, t_travail_sol *trav, int caisse) {
+    int pas = niv->voisin[DIR_BAS];
+    int coins[4] = { caisse, caisse - 1, caisse - pas, caisse - pas - 1 };
+
+    for (int k = 0; k < 4; k++) {
+        bool fige = true, horsCible = false;
+        for (int m = 0; m < 4 && fige; m++) {
+            int c = coins[k] + (m / 2) * pas + m % 2;
+            fige = niv->murs[c] || trav->occupe[c];
+            horsCible = horsCible || (trav->occupe[c] && !niv->cibles[c]);
+        }
+        if (fige && horsCible) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+* @brief Insère une clé dans la table de transposition, sans verrou :
+* plusieurs fils d'exécution peuvent l'appeler en même temps
+* @param tt de type *t_table_tt : la table (adressage ouvert)
+* @param cle de type uint64_t : la clé Zobrist de l'état
+* @return SOL_NOUVEAU si la clé a été ajoutée, SOL_DEJA_VU si elle était
+* présente, SOL_PLEINE si la table a atteint sa charge maximale
+*/
+static int tt_inserer(t_table_tt *tt, uint64_t cle) {
+    size_t i;
+    uint64_t attendu;
+
+    if (cle == 0) {
+        cle = 1;    // 0 marque une entrée libre
+    }
+    if (__atomic_load_n(&tt->occupes, __ATOMIC_RELAXED) * 4 
+        >= (tt->masque + 1) * 3) {
+        return SOL_PLEINE;
+    }
+    i = (size_t)cle & tt->masque;
+    for (;;) {
+        attendu = __atomic_load_n(&tt->cles[i], __ATOMIC_RELAXED);
+        if (attendu == cle) {
+            return SOL_DEJA_VU;
+        }
+        if (attendu == 0) {
+            if (__atomic_compare_exchange_n(&tt->cles[i], &attendu, cle, false,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                __atomic_add_fetch(&tt->occupes, 1, __ATOMIC_RELAXED);
+                return SOL_NOUVEAU;
+            }
+            if (attendu == cle) {
+                return SOL_DEJA_VU;
+            }
+        }
+        i = (i + 1) & tt->masque;
+    }
+}
+
+
+/**
+* @brief Donne le nœud désigné par une référence (fil d'exécution, indice)
+* @param sol de type *t_solveur : la recherche
+* @param ref de type int64_t : la référence du nœud
+* @return le nœud
+*/
+static t_noeud_sol *noeud_ref(t_solveur *sol, int64_t ref) {
+    t_arene *arene = &sol->ouvriers[ref >> 32].arene;
+    uint32_t k = (uint32_t)ref;
+    return &arene->blocs[k / SOL_BLOC][k % SOL_BLOC];
+}
+
+
+/**
+* @brief Donne les positions des caisses du nœud désigné par une référence
+* @param sol de type *t_solveur : la recherche
+* @param ref de type int64_t : la référence du nœud
+* @return les cases des caisses
+*/
+static uint16_t *caisses_ref(t_solveur *sol, int64_t ref) {
+    t_arene *arene = &sol->ouvriers[ref >> 32].arene;
+    uint32_t k = (uint32_t)ref;
+    return arene->caisses[k / SOL_BLOC] 
+        + (size_t)(k % SOL_BLOC) * (size_t)sol->niv->nbCaisses;
+}
+
+
+/**
+* @brief Réserve de la mémoire sur la limite commune à toute la recherche
+* @param sol de type *t_solveur : la recherche
+* @param octets de type size_t : la taille demandée
+* @return false si la limite serait dépassée
+*/
+static bool memoire_reserver(t_solveur *sol, size_t octets) {
+    size_t apres = __atomic_add_fetch(&sol->memoire, octets, __ATOMIC_RELAXED);
+    if (apres > sol->memoireMax) {
+        __atomic_sub_fetch(&sol->memoire, octets, __ATOMIC_RELAXED);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+* @brief Ajoute un nœud à l'arène d'un fil d'exécution ; l'arène grandit
+* par blocs qui ne sont jamais déplacés, si bien que les autres fils
+* peuvent lire ses nœuds pendant qu'elle grandit
+* @param sol de type *t_solveur : la recherche
+* @param o de type int : le numéro du fil d'exécution
+* @return la référence du nouveau nœud, ou -1 si la mémoire est épuisée
+*/
+static int64_t noeud_nouveau(t_solveur *sol, int o) {
+    t_arene *arene = &sol->ouvriers[o].arene;
+    int b = (int)(arene->nb / SOL_BLOC);
+
+    if (arene->nb % SOL_BLOC == 0) {
+        size_t octetsCaisses = (size_t)SOL_BLOC * (size_t)sol->niv->nbCaisses 
+            * sizeof(uint16_t);
+        if (b == arene->maxBlocs || !memoire_reserver(sol, 
+            SOL_BLOC * sizeof(t_noeud_sol) + octetsCaisses)) {
+            return -1;
+        }
+        arene->blocs[b] = malloc(SOL_BLOC * sizeof(t_noeud_sol));
+        arene->caisses[b] = malloc(octetsCaisses + sizeof(uint16_t));
+        if (arene->blocs[b] == NULL || arene->caisses[b] == NULL) {
+            return -1;
+        }
+    }
+    return ((int64_t)o << 32) | (int64_t)arene->nb++;
+}
+
+
+/**
+* @brief Ajoute une entrée dans le tas de priorité des nœuds à développer
+* @param sol de type *t_solveur : la recherche
+* @param priorite de type uint64_t : la priorité (la plus petite sort d'abord)
+* @return false si la mémoire est épuisée
+*/
+static bool tas_ajouter(t_solveur *sol, uint64_t priorite) {
+    size_t i, p;
+
+    if (sol->tailleTas == sol->capaTas) {
+        size_t capa = (sol->capaTas == 0) ? 4096 : sol->capaTas * 2;
+        uint64_t *tas;
+        if (!memoire_reserver(sol, (capa - sol->capaTas) * sizeof(uint64_t))) {
+            return false;
+        }
+        tas = realloc(sol->tas, capa * sizeof(uint64_t));
+        if (tas == NULL) {
+            return false;
+        }
+        sol->tas = tas;
+        sol->capaTas = capa;
+    }
+    i = sol->tailleTas++;
+    while (i > 0) {
+        p = (i - 1) / 2;
+        if (sol->tas[p] <= priorite) {
+            break;
+        }
+        sol->tas[i] = sol->tas[p];
+        i = p;
+    }
+    sol->tas[i] = priorite;
+    return true;
+}
+
+
+/**
+* @brief Retire l'entrée de plus petite priorité du tas
+* @param sol de type *t_solveur : la recherche (tas non vide)
+* @return la priorité retirée
+*/
+static uint64_t tas_retirer(t_solveur *sol) {
+    uint64_t res = sol->tas[0];
+    uint64_t dernier = sol->tas[--sol->tailleTas];
+    size_t i = 0, f;
+
+    while ((f = 2 * i + 1) < sol->tailleTas) {
+        if (f + 1 < sol->tailleTas && sol->tas[f + 1] < sol->tas[f]) {
+            f++;
+        }
+        if (dernier <= sol->tas[f]) {
+            break;
+        }
+        sol->tas[i] = sol->tas[f];
+        i = f;
+    }
+    if (sol->tailleTas > 0) {
+        sol->tas[i] = dernier;
+    }
+    return res;
+}
+
+
+/**
+* @brief Calcule la priorité d'un nœud pour le tas (A* : f = g + h,
+* à égalité le plus petit h d'abord)
+* @param noeud de type *t_noeud_sol : le nœud
+* @param indice de type int64_t : la référence du nœud (fil 0)
+* @return la priorité
+*/
+static uint64_t priorite_noeud(t_noeud_sol *noeud, int64_t indice) {
+    uint64_t f = (uint64_t)noeud->g + noeud->h;
+    return (f << 48) | ((uint64_t)noeud->h << 32) | (uint32_t)indice;
+}
+
+
+/**
+* @brief Engendre les états atteignables par une poussée depuis un nœud
+* et garde ceux que la table de transposition ne connaissait pas
+* @param sol de type *t_solveur : la recherche
+* @param o de type int : le numéro du fil d'exécution
+* @param n de type int64_t : la référence du nœud à développer
+* @param fils de type *t_fils_sol : reçoit les nouveaux états (au plus
+* NB_DIRECTIONS par caisse)
+* @return le nombre de fils, ou -1 si la table de transposition est pleine
+*/
+static int engendrer(t_solveur *sol, int o, int64_t n, t_fils_sol *fils) {
+    t_niveau_sol *niv = sol->niv;
+    t_travail_sol *trav = &sol->ouvriers[o].trav;
+    t_noeud_sol *pere = noeud_ref(sol, n);
+    uint16_t *caisses = caisses_ref(sol, n);
+    int nb = niv->nbCaisses;
+    int nbFils = 0;
+    uint32_t gen;
+
+    for (int b = 0; b < nb; b++) {
+        trav->occupe[caisses[b]] = 1;
+    }
+    zone_joueur(niv, trav, pere->joueur, trav->vu);
+    gen = trav->generation;
+
+    for (int b = 0; b < nb && nbFils >= 0; b++) {
+        int caisse = caisses[b];
+        for (int d = 0; d < NB_DIRECTIONS; d++) {
+            int derriere = caisse - niv->voisin[d];
+            int dest = caisse + niv->voisin[d];
+            if (trav->vu[derriere] != gen || niv->murs[dest] || 
+                trav->occupe[dest] || niv->distance[dest] == SOL_INFINI) {
+                continue;
+            }
+            // état fils : la caisse avance, le joueur prend sa place
+            trav->occupe[caisse] = 0;
+            trav->occupe[dest] = 1;
+            bool fige = solveur_fige(niv, trav, dest);
+            int zone = fige ? 0 : zone_joueur(niv, trav, caisse, trav->vuFils);
+            trav->occupe[dest] = 0;
+            trav->occupe[caisse] = 1;
+            if (fige) {
+                continue;
+            }
+
+            uint64_t cleCaisses = pere->cleCaisses ^ niv->zCaisse[caisse] 
+                ^ niv->zCaisse[dest];
+            int etat = tt_inserer(&sol->tt, cleCaisses ^ niv->zJoueur[zone]);
+            if (etat == SOL_DEJA_VU) {
+                continue;
+            }
+            if (etat == SOL_PLEINE) {
+                nbFils = -1;
+                break;
+            }
+            t_fils_sol *f = &fils[nbFils++];
+            f->caisse = (uint16_t)b;
+            f->dest = (uint16_t)dest;
+            f->dir = (uint8_t)d;
+            f->h = (uint16_t)(pere->h - niv->distance[caisse] 
+                + niv->distance[dest]);
+            f->ciblesLibres = (uint16_t)(pere->ciblesLibres 
+                + niv->cibles[caisse] - niv->cibles[dest]);
+            f->cleCaisses = cleCaisses;
+        }
+    }
+    for (int b = 0; b < nb; b++) {
+        trav->occupe[caisses[b]] = 0;
+    }
+    return nbFils;
+}
+
+
+/**
+* @brief Range un état engendré dans un nouveau nœud
+* @param sol de type *t_solveur : la recherche
+* @param o de type int : le numéro du fil d'exécution
+* @param n de type int64_t : la référence du père
+* @param f de type *t_fils_sol : l'état engendré
+* @return la référence du nouveau nœud, ou -1 si la mémoire est épuisée
+*/
+static int64_t creer_fils(t_solveur *sol, int o, int64_t n, t_fils_sol *f) {
+    int nb = sol->niv->nbCaisses;
+    int64_t r = noeud_nouveau(sol, o);
+    if (r < 0) {
+        return -1;
+    }
+    t_noeud_sol *pere = noeud_ref(sol, n);
+    uint16_t *caissesPere = caisses_ref(sol, n);
+    t_noeud_sol *noeud = noeud_ref(sol, r);
+    uint16_t *caisses = caisses_ref(sol, r);
+
+    noeud->parent = n;
+    noeud->joueur = caissesPere[f->caisse];
+    noeud->dir = f->dir;
+    noeud->g = pere->g + 1;
+    noeud->h = f->h;
+    noeud->ciblesLibres = f->ciblesLibres;
+    noeud->cleCaisses = f->cleCaisses;
+    memcpy(caisses, caissesPere, (size_t)nb * sizeof(uint16_t));
+    caisses[f->caisse] = f->dest;
+    return r;
+}
+
+
+/**
+* @brief Alloue l'arène et les tableaux de travail d'un fil d'exécution
+* @param sol de type *t_solveur : la recherche
+* @param o de type int : le numéro du fil d'exécution
+*/
+static void ouvrier_init(t_solveur *sol, int o) {
+    t_ouvrier *ouv = &sol->ouvriers[o];
+    size_t parBloc = SOL_BLOC * (sizeof(t_noeud_sol) 
+        + (size_t)sol->niv->nbCaisses * sizeof(uint16_t));
+
+    ouv->sol = sol;
+    ouv->num = o;
+    ouv->arene.nb = 0;
+    ouv->arene.maxBlocs = (int)(sol->memoireMax / parBloc) + 1;
+    ouv->arene.blocs = calloc((size_t)ouv->arene.maxBlocs, sizeof(t_noeud_sol *));
+    ouv->arene.caisses = calloc((size_t)ouv->arene.maxBlocs, sizeof(uint16_t *));
+    ouv->fils = malloc((size_t)sol->niv->nbCaisses * NB_DIRECTIONS 
+        * sizeof(t_fils_sol));
+    ouv->pile.refs = NULL;
+    ouv->pile.debut = 0;
+    ouv->pile.fin = 0;
+    ouv->pile.capa = 0;
+    pthread_mutex_init(&ouv->pile.verrou, NULL);
+    ouv->developpes = 0;
+    if (ouv->arene.blocs == NULL || ouv->arene.caisses == NULL || 
+        ouv->fils == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    travail_init(&ouv->trav, sol->niv);
+}
+
+
+/**
+* @brief Libère l'arène et les tableaux de travail d'un fil d'exécution
+* @param ouv de type *t_ouvrier : le fil d'exécution
+*/
+static void ouvrier_liberer(t_ouvrier *ouv) {
+    for (int b = 0; b < ouv->arene.maxBlocs; b++) {
+        free(ouv->arene.blocs[b]);
+        free(ouv->arene.caisses[b]);
+    }
+    free(ouv->arene.blocs);
+    free(ouv->arene.caisses);
+    free(ouv->fils);
+    free(ouv->pile.refs);
+    pthread_mutex_destroy(&ouv->pile.verrou);
+    travail_liberer(&ouv->trav);
+}
+
+
+/**
+* @brief Prépare une recherche : table de transposition et nœud racine
+* @param sol de type *t_solveur : la recherche, dont niv, memoireMax et
+* nbOuvriers sont renseignés
+* @return la référence du nœud racine, -2 si la limite de mémoire est
+* atteinte
+*/
+static int64_t solveur_commencer(t_solveur *sol) {
+    t_niveau_sol *niv = sol->niv;
+    t_travail_sol *trav;
+    size_t cases = 1;
+
+    sol->tas = NULL;
+    sol->tailleTas = sol->capaTas = 0;
+    sol->fini = 0;
+    sol->solution = -1;
+    sol->enCours = 0;
+
+    // la table de transposition prend au plus un quart de la mémoire
+    while (cases * 2 * sizeof(uint64_t) <= sol->memoireMax / 4) {
+        cases *= 2;
+    }
+    sol->tt.cles = calloc(cases, sizeof(uint64_t));
+    sol->ouvriers = malloc((size_t)sol->nbOuvriers * sizeof(t_ouvrier));
+    if (sol->tt.cles == NULL || sol->ouvriers == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    sol->tt.masque = cases - 1;
+    sol->tt.occupes = 0;
+    sol->memoire = cases * sizeof(uint64_t);
+    for (int o = 0; o < sol->nbOuvriers; o++) {
+        ouvrier_init(sol, o);
+    }
+
+    // nœud racine, dans l'arène du premier fil
+    int64_t r = noeud_nouveau(sol, 0);
+    if (r < 0) {
+        return -2;
+    }
+    t_noeud_sol *racine = noeud_ref(sol, r);
+    uint16_t *caisses = caisses_ref(sol, r);
+    trav = &sol->ouvriers[0].trav;
+    racine->parent = -1;
+    racine->joueur = (uint16_t)niv->joueurDepart;
+    racine->dir = 0;
+    racine->g = 0;
+    racine->h = 0;
+    racine->cleCaisses = 0;
+    racine->ciblesLibres = (uint16_t)niv->ciblesLibres;
+    for (int b = 0; b < niv->nbCaisses; b++) {
+        int c = niv->caissesDepart[b];
+        caisses[b] = (uint16_t)c;
+        racine->h = (uint16_t)(racine->h + niv->distance[c]);
+        racine->cleCaisses ^= niv->zCaisse[c];
+        trav->occupe[c] = 1;
+    }
+    int zone = zone_joueur(niv, trav, niv->joueurDepart, trav->vu);
+    for (int b = 0; b < niv->nbCaisses; b++) {
+        trav->occupe[niv->caissesDepart[b]] = 0;
+    }
+    tt_inserer(&sol->tt, racine->cleCaisses ^ niv->zJoueur[zone]);
+    return r;
+}
+
+
+/**
+* @brief Recherche A* d'une solution sur un seul fil, poussée par poussée
+* @param sol de type *t_solveur : la recherche, dont niv et memoireMax
+* sont renseignés
+* @return la référence du nœud solution, -1 si le niveau n'a pas de
+* solution, -2 si la limite de mémoire a été atteinte
+*/
+int64_t solveur_chercher(t_solveur *sol) {
+    t_ouvrier *ouv;
+    int64_t res = -1;
+
+    sol->nbOuvriers = 1;
+    int64_t r = solveur_commencer(sol);
+    ouv = &sol->ouvriers[0];
+    if (r < 0) {
+        return r;
+    }
+    if (noeud_ref(sol, r)->ciblesLibres == 0) {
+        return r;
+    }
+    if (sol->niv->perdu) {
+        return -1;
+    }
+    tas_ajouter(sol, priorite_noeud(noeud_ref(sol, r), r));
+
+    while (sol->tailleTas > 0 && res == -1) {
+        int64_t n = (int64_t)(tas_retirer(sol) & 0xFFFFFFFFu);
+        int nbFils = engendrer(sol, 0, n, ouv->fils);
+        ouv->developpes++;
+        if (nbFils < 0) {
+            res = -2;
+        }
+        for (int k = 0; k < nbFils && res == -1; k++) {
+            int64_t f = creer_fils(sol, 0, n, &ouv->fils[k]);
+            if (f < 0) {
+                res = -2;
+            } else if (noeud_ref(sol, f)->ciblesLibres == 0) {
+                res = f;
+            } else if (!tas_ajouter(sol, priorite_noeud(noeud_ref(sol, f), f))) {
+                res = -2;
+            }
+        }
+    }
+    return res;
+}
+
+
+/**
+* @brief Empile une référence au bas de la pile d'un fil (côté propriétaire)
+* @param sol de type *t_solveur : la recherche
+* @param pile de type *t_pile_sol : la pile
+* @param ref de type int64_t : la référence du nœud
+* @return false si la mémoire est épuisée
+*/
+static bool pile_empiler(t_solveur *sol, t_pile_sol *pile, int64_t ref) {
+    bool ok = true;
+    pthread_mutex_lock(&pile->verrou);
+    if (pile->fin == pile->capa) {
+        size_t n = pile->fin - pile->debut;
+        if (pile->debut > pile->capa / 2) {
+            // le haut de la pile a été volé : on recale sans agrandir
+            memmove(pile->refs, pile->refs + pile->debut, n * sizeof(int64_t));
+        } else {
+            size_t capa = (pile->capa == 0) ? 1024 : pile->capa * 2;
+            int64_t *refs = NULL;
+            if (memoire_reserver(sol, (capa - pile->capa) * sizeof(int64_t))) {
+                refs = realloc(pile->refs, capa * sizeof(int64_t));
+            }
+            if (refs == NULL) {
+                ok = false;
+            } else {
+                memmove(refs, refs + pile->debut, n * sizeof(int64_t));
+                pile->refs = refs;
+                pile->capa = capa;
+            }
+        }
+        if (ok) {
+            pile->debut = 0;
+            pile->fin = n;
+        }
+    }
+    if (ok) {
+        pile->refs[pile->fin++] = ref;
+    }
+    pthread_mutex_unlock(&pile->verrou);
+    return ok;
+}
+
+
+/**
+* @brief Prend une référence dans une pile : au bas pour son propriétaire
+* (le dernier fils engendré), en haut pour un voleur (le plus ancien)
+* @param pile de type *t_pile_sol : la pile
+* @param vol de type bool : true si l'appelant vole le travail d'un autre fil
+* @return la référence, ou -1 si la pile est vide
+*/
+static int64_t pile_prendre(t_pile_sol *pile, bool vol) {
+    int64_t ref = -1;
+    pthread_mutex_lock(&pile->verrou);
+    if (pile->fin > pile->debut) {
+        ref = vol ? pile->refs[pile->debut++] : pile->refs[--pile->fin];
+    }
+    pthread_mutex_unlock(&pile->verrou);
+    return ref;
+}
+
+
+/**
+* @brief Boucle d'un fil de la recherche parallèle : développe les nœuds
+* de sa pile, en profondeur d'abord et meilleur fils en premier, et vole
+* le travail des autres fils quand sa pile est vide
+* @param arg de type *t_ouvrier : le fil d'exécution
+* @return NULL
+*/
+static void *ouvrier_boucle(void *arg) {
+    t_ouvrier *ouv = arg;
+    t_solveur *sol = ouv->sol;
+    int o = ouv->num;
+    uint64_t graine = 0x9E3779B97F4A7C15ull * (uint64_t)(o + 1);
+
+    while (!__atomic_load_n(&sol->fini, __ATOMIC_ACQUIRE)) {
+        int64_t n = pile_prendre(&ouv->pile, false);
+        for (int essai = 0; n < 0 && essai < sol->nbOuvriers; essai++) {
+            int victime = (int)(aleatoire64(&graine) % (uint64_t)sol->nbOuvriers);
+            if (victime != o) {
+                n = pile_prendre(&sol->ouvriers[victime].pile, true);
+            }
+        }
+        if (n < 0) {
+            if (__atomic_load_n(&sol->enCours, __ATOMIC_ACQUIRE) == 0) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+
+        int nbFils = engendrer(sol, o, n, ouv->fils);
+        int etat = 0;
+        int64_t trouve = -1;
+        ouv->developpes++;
+        if (nbFils < 0) {
+            etat = -2;
+        }
+        // tri par h décroissant : le meilleur fils est empilé en dernier
+        for (int i = 1; i < nbFils; i++) {
+            t_fils_sol f = ouv->fils[i];
+            int j = i;
+            while (j > 0 && ouv->fils[j - 1].h < f.h) {
+                ouv->fils[j] = ouv->fils[j - 1];
+                j--;
+            }
+            ouv->fils[j] = f;
+        }
+        for (int k = 0; k < nbFils && etat == 0; k++) {
+            int64_t f = creer_fils(sol, o, n, &ouv->fils[k]);
+            if (f < 0) {
+                etat = -2;
+            } else if (noeud_ref(sol, f)->ciblesLibres == 0) {
+                trouve = f;
+                etat = 1;
+            } else {
+                __atomic_add_fetch(&sol->enCours, 1, __ATOMIC_RELEASE);
+                if (!pile_empiler(sol, &ouv->pile, f)) {
+                    __atomic_sub_fetch(&sol->enCours, 1, __ATOMIC_RELEASE);
+                    etat = -2;
+                }
+            }
+        }
+        if (etat != 0) {
+            int attendu = 0;
+            // le premier fil qui conclut fixe le résultat
+            if (__atomic_compare_exchange_n(&sol->fini, &attendu, 
+                etat == 1 ? 1 : 2, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) 
+                && etat == 1) {
+                sol->solution = trouve;
+            }
+        }
+        __atomic_sub_fetch(&sol->enCours, 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+
+/**
+* @brief Recherche parallèle d'une solution (profondeur d'abord guidée
+* par h, piles à vol de travail, table de transposition partagée)
+* @param sol de type *t_solveur : la recherche, dont niv, memoireMax et
+* nbOuvriers sont renseignés
+* @return la référence du nœud solution, -1 si le niveau n'a pas de
+* solution, -2 si la limite de mémoire a été atteinte
+*/
+int64_t solveur_chercher_parallele(t_solveur *sol) {
+    pthread_t *fils;
+    int64_t r = solveur_commencer(sol);
+
+    if (r < 0) {
+        return r;
+    }
+    if (noeud_ref(sol, r)->ciblesLibres == 0) {
+        return r;
+    }
+    if (sol->niv->perdu) {
+        return -1;
+    }
+    fils = malloc((size_t)sol->nbOuvriers * sizeof(pthread_t));
+    if (fils == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    sol->enCours = 1;
+    pile_empiler(sol, &sol->ouvriers[0].pile, r);
+    for (int o = 0; o < sol->nbOuvriers; o++) {
+        pthread_create(&fils[o], NULL, ouvrier_boucle, &sol->ouvriers[o]);
+    }
+    for (int o = 0; o < sol->nbOuvriers; o++) {
+        pthread_join(fils[o], NULL);
+    }
+    free(fils);
+    if (sol->fini == 1) {
+        return sol->solution;
+    }
+    return (sol->fini == 2) ? -2 : -1;
+}
+
+
+/**
+* @brief Additionne les nœuds engendrés et développés par tous les fils
+* @param sol de type *t_solveur : la recherche
+* @param engendres de type *long : reçoit le nombre de nœuds engendrés
+* @return le nombre de nœuds développés
+*/
+long solveur_compter(t_solveur *sol, long *engendres) {
+    long developpes = 0;
+    *engendres = 0;
+    for (int o = 0; o < sol->nbOuvriers; o++) {
+        developpes += sol->ouvriers[o].developpes;
+        *engendres += (long)sol->ouvriers[o].arene.nb;
+    }
+    return developpes;
+}
+
+
+/**
+* @brief Libère la mémoire d'une recherche
+* @param sol de type *t_solveur : la recherche
+*/
+void solveur_terminer(t_solveur *sol) {
+    for (int o = 0; o < sol->nbOuvriers; o++) {
+        ouvrier_liberer(&sol->ouvriers[o]);
+    }
+    free(sol->ouvriers);
+    free(sol->tas);
+    free(sol->tt.cles);
+}
+
+
+/**
+* @brief Reconstitue les déplacements d'une solution, marche comprise,
+* en les rejouant avec les règles du jeu
+* @param sol de type *t_solveur : la recherche terminée
+* @param fin de type int64_t : le nœud solution
+* @param plat de type *t_plateau : le plateau de départ (modifié)
+* @param joueur de type int : la case de départ du joueur
+* @param depl de type *t_tab_deplacement : reçoit les coups
+* @return true si le plateau est résolu après les coups rejoués
+*/
+bool solveur_solution(t_solveur *sol, int64_t fin, t_plateau *plat, 
+    int joueur, t_tab_deplacement *depl) {
+    t_niveau_sol *niv = sol->niv;
+    t_travail_sol *trav = &sol->ouvriers[0].trav;
+    int64_t *chemin;
+    int longueur = 0;
+    int nbPas;
+    uint8_t *pas;
+
+    for (int64_t n = fin; noeud_ref(sol, n)->parent >= 0; 
+         n = noeud_ref(sol, n)->parent) {
+        longueur++;
+    }
+    chemin = malloc((size_t)(longueur + 1) * sizeof(int64_t));
+    pas = malloc((size_t)niv->total);
+    if (chemin == NULL || pas == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    int i = longueur;
+    for (int64_t n = fin; noeud_ref(sol, n)->parent >= 0; 
+         n = noeud_ref(sol, n)->parent) {
+        chemin[--i] = n;
+    }
+    for (int k = 0; k < longueur; k++) {
+        t_noeud_sol *noeud = noeud_ref(sol, chemin[k]);
+        int d = noeud->dir;
+        int derriere = noeud->joueur - niv->voisin[d];
+
+        // marche jusqu'à la case derrière la caisse
+        for (int c = 0; c < niv->total; c++) {
+            trav->occupe[c] = (plat->cases[c] & CASE_CAISSE) != 0;
+        }
+        zone_joueur(niv, trav, joueur, trav->vu);
+        nbPas = 0;
+        for (int c = derriere; c != joueur; c -= niv->voisin[trav->venu[c]]) {
+            pas[nbPas++] = trav->venu[c];
+        }
+        while (nbPas > 0) {
+            verifier_memoire(depl_ajouter(depl, 
+                jouer_coup(plat, &joueur, pas[--nbPas])));
+        }
+        verifier_memoire(depl_ajouter(depl, jouer_coup(plat, &joueur, d)));
+    }
+    memset(trav->occupe, 0, (size_t)niv->total);
+    free(chemin);
+    free(pas);
+    return gagne(plat);
+}
+
+
+/**
+* @brief Mode --solve : cherche une solution et l'affiche avec les codes
+* de enregistrerDeplacements()
+* @param fichier de type char : le niveau .sok
+* @param memoireMo de type long : la limite de mémoire en Mo
+* @param sortie de type char : fichier où enregistrer la solution (ou NULL)
+* @param nbThreads de type int : 0 pour la recherche A* sur un fil,
+* sinon le nombre de fils de la recherche parallèle
+* @return 0 si une solution a été trouvée, 1 sinon
+*/
+int resoudre(char fichier[], long memoireMo, char sortie[], int nbThreads) {
+    t_plateau plat;
+    t_niveau_sol niv;
+    t_solveur sol;
+    t_tab_deplacement depl;
+    struct rusage usage;
+    int joueur = -1;
+    int64_t fin;
+    double debut, duree;
+    long poussees = 0, developpes, engendres;
+
+    plat.cases = NULL;
+    if (!charger_partie(&plat, fichier, &joueur)) {
+        plateau_liberer(&plat);
+        return 1;
+    }
+    if (!solveur_preparer(&niv, &plat, joueur)) {
+        printf("niveau trop grand pour le solveur\n");
+        plateau_liberer(&plat);
+        return 1;
+    }
+    sol.niv = &niv;
+    sol.memoireMax = (size_t)memoireMo * 1024 * 1024;
+    debut = bench_horloge();
+    if (nbThreads > 0) {
+        sol.nbOuvriers = nbThreads;
+        fin = solveur_chercher_parallele(&sol);
+    } else {
+        fin = solveur_chercher(&sol);
+    }
+    duree = bench_horloge() - debut;
+
+    if (fin >= 0) {
+        depl_init(&depl);
+        solveur_solution(&sol, fin, &plat, joueur, &depl);
+        for (long k = 0; k < depl.nb; k++) {
+            char code = coup_vers_code(depl_lire(&depl, k));
+            putchar(code);
+            poussees += (depl_lire(&depl, k) & COUP_POUSSEE) != 0;
+        }
+        printf("\n");
+        printf("solution : %ld coups, %ld poussées\n", depl.nb, poussees);
+        if (sortie != NULL) {
+            enregistrerDeplacements(&depl, &plat, sortie);
+        }
+        depl_liberer(&depl);
+    } else if (fin == -1) {
+        printf("pas de solution\n");
+    } else {
+        printf("limite de mémoire atteinte (%ld Mo)\n", memoireMo);
+    }
+    getrusage(RUSAGE_SELF, &usage);
+    developpes = solveur_compter(&sol, &engendres);
+    printf("fils d'exécution : %d\n", sol.nbOuvriers);
+    printf("noeuds : %ld développés, %ld engendrés, %.0f noeuds/s\n",
+        developpes, engendres, duree > 0 ? (double)engendres / duree : 0.0);
+    printf("mémoire : %.1f Mo pour la recherche, pic du processus %.1f Mo\n",
+        (double)sol.memoire / (1024 * 1024), (double)usage.ru_maxrss / 1024);
+    printf("temps : %.3f s\n", duree);
+
+    solveur_terminer(&sol);
+    solveur_liberer(&niv);
+    plateau_liberer(&plat);
+    return (fin >= 0) ? 0 : 1;
+}
+
+
+// Vérification de solutions
+
+
+/**
+* @brief Rejoue un fichier de coups sur un niveau, avec les règles de
+* deplacer() mais sans terminal ni affichage. Le fichier est soit un
+* journal binaire (voir t_journal), dont l'empreinte doit être celle du
+* niveau, soit un texte de codes SOKO_* / CAISSE_* dont les blancs et
+* fins de ligne sont ignorés ; il est lu au fil de l'eau.
+* Un coup est illégal si son code est inconnu, s'il est bloqué par un mur
+* ou une caisse, ou s'il annonce une poussée qui n'a pas lieu (ou l'inverse).
+* @param rejeu de type *t_rejeu : niveau et coups à vérifier ; le résultat
+* y est rangé
+*/
+void rejouer(t_rejeu *rejeu) {
+    t_plateau plat;
+    t_journal j;
+    FILE *f = NULL;
+    bool binaire;
+    int joueur = -1;
+    int res;
+
+    rejeu->etat = REJEU_FICHIER;
+    rejeu->nbCoups = 0;
+    rejeu->poussees = 0;
+    rejeu->illegal = 0;
+    rejeu->codeIllegal = 0;
+    // un niveau illisible ne concerne que cette entrée du lot
+    plat.cases = NULL;
+    res = lire_niveau(&plat, rejeu->niveau, &joueur);
+    if (res != SOKOBAN_OK) {
+        if (res == SOKOBAN_INVALIDE) {
+            rejeu->etat = REJEU_SANS_JOUEUR;
+        }
+        plateau_liberer(&plat);
+        return;
+    }
+    binaire = journal_ouvrir(&j, rejeu->coups);
+    if (!binaire && (f = fopen(rejeu->coups, "r")) == NULL) {
+        plateau_liberer(&plat);
+        return;
+    }
+
+    rejeu->etat = REJEU_NON_RESOLU;
+    if (binaire && j.empreinte != plat.empreinte) {
+        rejeu->etat = REJEU_AUTRE_NIVEAU;
+    }
+    while (rejeu->etat == REJEU_NON_RESOLU) {
+        int attendu;
+        char code;
+        if (binaire) {
+            attendu = journal_lire(&j);
+            if (attendu == JOURNAL_FIN) {
+                break;
+            }
+            if (attendu == JOURNAL_ERREUR) {
+                rejeu->etat = REJEU_FICHIER;
+                break;
+            }
+            code = coup_vers_code(attendu);
+        } else {
+            int c = getc(f);
+            if (c == EOF) {
+                break;
+            }
+            code = (char)c;
+            if (code == '\n' || code == '\r' || code == VIDE) {
+                continue;
+            }
+            attendu = code_vers_coup(code);
+        }
+        int coup = (attendu < 0) ? -1 : jouer_coup(&plat, &joueur, attendu & 3);
+        if (coup < 0 || coup != attendu) {
+            rejeu->etat = REJEU_ILLEGAL;
+            rejeu->illegal = rejeu->nbCoups + 1;
+            rejeu->codeIllegal = code;
+            break;
+        }
+        rejeu->nbCoups++;
+        rejeu->poussees += (coup & COUP_POUSSEE) != 0;
+    }
+    if (rejeu->etat == REJEU_NON_RESOLU && gagne(&plat)) {
+        rejeu->etat = REJEU_RESOLU;
+    }
+    if (binaire) {
+        journal_fermer(&j);
+    } else {
+        fclose(f);
+    }
+    plateau_liberer(&plat);
+}
+
+
+/**
+* @brief Boucle d'un fil de vérification : prend les vérifications dans
+* l'ordre jusqu'à épuisement du lot
+* @param arg de type *t_lot_rejeu : le lot partagé
+* @return NULL
+*/
+static void *rejeu_boucle(void *arg) {
+    t_lot_rejeu *lot = arg;
+    int k;
+
+    while ((k = __atomic_fetch_add(&lot->suivant, 1, __ATOMIC_RELAXED)) < lot->nb) {
+        rejouer(&lot->rejeux[k]);
+    }
+    return NULL;
+}
+
+
+/**
+* @brief Mode --replay : vérifie des paires (niveau, coups) sur plusieurs
+* fils d'exécution et affiche un résultat par paire, dans l'ordre donné
+* @param fichiers de type *char[] : niveau et fichier de coups, alternés
+* @param nb de type int : le nombre de paires
+* @param nbThreads de type int : le nombre de fils (0 : un par processeur)
+* @return 0 si toutes les solutions résolvent leur niveau, 1 sinon
+*/
+int verifier_solutions(char *fichiers[], int nb, int nbThreads) {
+    t_lot_rejeu lot;
+    pthread_t *fils;
+    int resolus = 0;
+    double debut, duree;
+
+    if (nbThreads <= 0) {
+        nbThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (nbThreads > nb) {
+        nbThreads = nb;
+    }
+    if (nbThreads < 1) {
+        nbThreads = 1;
+    }
+    lot.rejeux = malloc((size_t)nb * sizeof(t_rejeu) + 1);
+    fils = malloc((size_t)nbThreads * sizeof(pthread_t));
+    if (lot.rejeux == NULL || fils == NULL) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    lot.nb = nb;
+    lot.suivant = 0;
+    for (int k = 0; k < nb; k++) {
+        lot.rejeux[k].niveau = fichiers[2 * k];
+        lot.rejeux[k].coups = fichiers[2 * k + 1];
+    }
+
+    debut = bench_horloge();
+    for (int t = 0; t < nbThreads; t++) {
+        pthread_create(&fils[t], NULL, rejeu_boucle, &lot);
+    }
+    for (int t = 0; t < nbThreads; t++) {
+        pthread_join(fils[t], NULL);
+    }
+    duree = bench_horloge() - debut;
+
+    for (int k = 0; k < nb; k++) {
+        t_rejeu *r = &lot.rejeux[k];
+        printf("%s %s : ", r->niveau, r->coups);
+        switch (r->etat) {
+            case REJEU_RESOLU:
+                printf("résolu, %ld coups, %ld poussées\n", r->nbCoups, r->poussees);
+                resolus++;
+                break;
+            case REJEU_NON_RESOLU:
+                printf("non résolu, %ld coups, %ld poussées\n", r->nbCoups, 
+                    r->poussees);
+                break;
+            case REJEU_ILLEGAL:
+                printf("coup illégal n°%ld ('%c'), après %ld coups et %ld "
+                    "poussées\n", r->illegal, r->codeIllegal, r->nbCoups, 
+                    r->poussees);
+                break;
+            case REJEU_AUTRE_NIVEAU:
+                printf("journal d'un autre niveau\n");
+                break;
+            case REJEU_SANS_JOUEUR:
+                printf("niveau sans joueur\n");
+                break;
+            default:
+                printf("fichier illisible\n");
+                break;
+        }
+    }
+    printf("%d/%d résolus, %d fils d'exécution, %.3f s\n", resolus, nb, 
+        nbThreads, duree);
+    free(lot.rejeux);
+    free(fils);
+    return (resolus == nb) ? 0 : 1;
+}
+
+
+// Partie scriptée
+
+
+/**
+* @brief Joue une partie sans terminal ni confirmation, avec les commandes
+* lues dans un script ou sur l'entrée standard : les touches du jeu
+* (zqsd, u, y, r, +, -, x), "g N" pour aller au coup N, "c L C" pour
+* aller à la case de la ligne L et de la colonne C (à partir de 1) et
+* "e fichier" pour enregistrer la partie (voir sauver_partie() ; le nom
+* ne contient ni blanc ni '#'). Les blancs sont ignorés et '#' commente
+* la fin de la ligne. La partie s'arrête à la
+* victoire, sur x ou à la fin du script.
+* @param niveau de type char[] : le niveau ou une sauvegarde à reprendre
+* @param script de type char[] : le fichier de commandes, NULL pour
+* l'entrée standard
+* @param resume de type bool : true pour afficher l'état final sur une ligne
+* @return 0, ou 1 si un fichier n'a pas pu être lu ou écrit
+*/
+int partie_script(char niveau[], char script[], bool resume) {
+    t_sokoban *partie;
+    t_cases_ecran modifs;
+    FILE *f = stdin;
+    int zoom = 1;
+    int c;
+    long commandes = 0;
+    int res = 0;
+
+    if (script != NULL && (f = fopen(script, "r")) == NULL) {
+        printf("ERREUR SUR FICHIER");
+        return 1;
+    }
+    // une seule sortie : le script et la partie sont toujours libérés
+    partie = ouvrir_partie(niveau);
+    if (partie == NULL) {
+        res = 1;
+    }
+
+    while (partie != NULL && !sokoban_gagne(partie) &&
+        (c = getc_unlocked(f)) != EOF && c != ABANDON) {
+        long n;
+        int i, j;
+        char nom[256];
+        switch (c) {
+            case HAUT:
+            case BAS:
+            case GAUCHE:
+            case DROITE:
+            case UNDO:
+            case REFAIRE:
+                modifs.n = 0;
+                jouer_touche(partie, (char)c, &modifs);
+                break;
+            case RECOMMENCE:
+                sokoban_recommencer(partie);
+                break;
+            case ZOOM:
+                def_zoom(&zoom, 1);
+                break;
+            case DE_ZOOM:
+                def_zoom(&zoom, -1);
+                break;
+            case ALLER:
+                if (fscanf(f, " %ld", &n) == 1) {
+                    sokoban_aller(partie, n);
+                }
+                break;
+            case MARCHER:
+                if (fscanf(f, " %d %d", &i, &j) == 2) {
+                    int pas = sokoban_marcher(partie, i - 1, j - 1);
+                    if (pas == SOKOBAN_BLOQUE || pas == SOKOBAN_INVALIDE) {
+                        printf("c %d %d : %s\n", i, j, ALERTE_INACCESSIBLE);
+                    } else if (pas == SOKOBAN_ERREUR_MEMOIRE) {
+                        printf("c %d %d : %s\n", i, j, ALERTE_MEMOIRE);
+                        res = 1;
+                    }
+                }
+                break;
+            case SAUVER:
+                // le nom s'arrête au premier blanc ou au commentaire
+                if (fscanf(f, " %255[^ \t\r\n#]", nom) == 1
+                    && !sauver_partie(nom, partie)) {
+                    res = 1;
+                }
+                break;
+            case '#':
+                while ((c = getc_unlocked(f)) != EOF && c != '\n') {
+                }
+                continue;
+            default:
+                continue;
+        }
+        commandes++;
+    }
+
+    if (resume && partie != NULL) {
+        printf("commandes %ld, coups %ld/%ld, %s, zoom %d, empreinte %016llx\n",
+            commandes, sokoban_nb_coups(partie), sokoban_nb_enregistres(partie),
+            sokoban_gagne(partie) ? "gagnée" : "en cours", zoom, 
+            (unsigned long long)sokoban_empreinte(partie));
+    }
+    if (f != stdin) {
+        fclose(f);
+    }
+    sokoban_liberer(partie);
+    return res;
+}
+
+
+// Mesures de la boucle de jeu
+
+
+#ifdef SOKOBAN_MESURES
+t_mesures mesures;
+
+
+/**
+* @brief Donne l'heure d'une horloge monotone
+* @return le temps en nanosecondes
+*/
+uint64_t mesures_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+
+/**
+* @brief Donne la case d'une valeur : les HISTO_SOUS premières valeurs ont
+* chacune leur case, puis chaque puissance de deux est coupée en
+* HISTO_SOUS cases
+* @param valeur de type uint64_t : la valeur
+* @return l'indice de la case
+*/
+static int histo_case(uint64_t valeur) {
+    int e;
+    if (valeur < HISTO_SOUS) {
+        return (int)valeur;
+    }
+    e = 63 - __builtin_clzll(valeur);
+    return (e - HISTO_SOUS_BITS + 1) * HISTO_SOUS 
+        + (int)((valeur >> (e - HISTO_SOUS_BITS)) & (HISTO_SOUS - 1));
+}
+
+
+/**
+* @brief Donne la plus petite valeur d'une case (inverse de histo_case())
+* @param k de type int : l'indice de la case
+* @return la valeur
+*/
+static uint64_t histo_valeur(int k) {
+    int e;
+    if (k < HISTO_SOUS) {
+        return (uint64_t)k;
+    }
+    e = k / HISTO_SOUS + HISTO_SOUS_BITS - 1;
+    return (uint64_t)(HISTO_SOUS + k % HISTO_SOUS) << (e - HISTO_SOUS_BITS);
+}
+
+
+/**
+* @brief Note une valeur dans un histogramme
+* @param histo de type *t_histo : l'histogramme
+* @param valeur de type uint64_t : la durée en nanosecondes
+*/
+void histo_noter(t_histo *histo, uint64_t valeur) {
+    histo->comptes[histo_case(valeur)]++;
+    histo->nb++;
+    histo->somme += valeur;
+    if (valeur > histo->max) {
+        histo->max = valeur;
+    }
+}
+
+
+/**
+* @brief Donne un quantile d'un histogramme, à la précision de ses cases
+* @param histo de type *t_histo : l'histogramme
+* @param q de type double : le quantile (0,5 pour la médiane)
+* @return la plus petite valeur de la case du quantile, 0 si vide
+*/
+uint64_t histo_quantile(t_histo *histo, double q) {
+    uint64_t rang = (uint64_t)(q * (double)histo->nb);
+    uint64_t vus = 0;
+
+    if (histo->nb == 0) {
+        return 0;
+    }
+    if (rang >= histo->nb) {
+        rang = histo->nb - 1;
+    }
+    for (int k = 0; k < HISTO_CASES; k++) {
+        vus += histo->comptes[k];
+        if (vus > rang) {
+            return histo_valeur(k);
+        }
+    }
+    return histo->max;
+}
+
+
+/**
+* @brief Note la durée écoulée depuis un début, s'il y en a un, puis
+* l'oublie
+* @param histo de type *t_histo : l'histogramme
+* @param debut de type *uint64_t : l'heure du début (mesures_ns()), 0 si
+* rien n'est en cours
+*/
+void mesures_fin(t_histo *histo, uint64_t *debut) {
+    if (*debut != 0) {
+        histo_noter(histo, mesures_ns() - *debut);
+        *debut = 0;
+    }
+}
+
+
+/**
+* @brief Écrit une ligne de résumé d'un histogramme
+* @param f de type *FILE : le fichier
+* @param nom de type char : le nom de la mesure
+* @param histo de type *t_histo : l'histogramme
+*/
+static void histo_ecrire(FILE *f, const char *nom, t_histo *histo) {
+    fprintf(f, "%-12s n=%llu moyenne=%.0f p50=%llu p90=%llu p99=%llu "
+        "p99.9=%llu max=%llu ns\n", nom, (unsigned long long)histo->nb,
+        (histo->nb > 0) ? (double)histo->somme / (double)histo->nb : 0.0,
+        (unsigned long long)histo_quantile(histo, 0.5),
+        (unsigned long long)histo_quantile(histo, 0.9),
+        (unsigned long long)histo_quantile(histo, 0.99),
+        (unsigned long long)histo_quantile(histo, 0.999),
+        (unsigned long long)histo->max);
+}
+
+
+/**
+* @brief Ajoute l'état des mesures à la fin du fichier de mesures
+* @param fichier de type char : le fichier de mesures
+* @param trame de type *t_trame : la trame, pour ses compteurs
+* @param raison de type char : ce qui a demandé l'écriture
+* @return true si le fichier a été écrit
+*/
+bool mesures_ecrire(char fichier[], t_trame *trame, const char *raison) {
+    FILE *f = fopen(fichier, "a");
+    if (f == NULL) {
+        return false;
+    }
+    fprintf(f, "== mesures (%s), pid %ld\n", raison, (long)getpid());
+    histo_ecrire(f, "touche_trame", &mesures.toucheTrame);
+    histo_ecrire(f, "traitement", &mesures.traitement);
+    histo_ecrire(f, "rendu", &mesures.rendu);
+    fprintf(f, "touches=%ld trames=%ld octets=%ld write=%ld poll=%ld read=%ld\n",
+        mesures.touches, trame->trames, trame->octetsTotal, trame->appelsTotal,
+        mesures.polls, mesures.lectures);
+    return fclose(f) == 0;
+}
+#endif
@@ -0,0 +1,2642 @@
+/**
+* @file libsokoban.c
+* @brief Moteur du jeu Sokoban : plateau, coups, historique et parties
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* Partagé par le jeu et par les programmes qui l'embarquent (voir
+* libsokoban.h). Ce fichier n'utilise ni stdio ni variable globale : les
+* erreurs d'allocation sont renvoyées à l'appelant, et deux parties
+* distinctes peuvent être jouées en même temps sur deux fils d'exécution.
+*
+*/
+
+/* Fichiers inclus */
+#include "sokoban.h"
+#include "libsokoban.h"
+
+
+// Plateau et coups
+
+
+/**
+* @brief Donne l'indice d'une case dans le tableau du plateau
+* @param plat de type *t_plateau : le plateau de jeu
+* @param i de type int : la ligne de la case
+* @param j de type int : la colonne de la case
+* @return l'indice de la case (i, j), bordure comprise
+*/
+int plateau_indice(t_plateau *plat, int i, int j) {
+    return (i + BORDURE) * plat->pas + (j + BORDURE);
+}
+
+
+/**
+* @brief Alloue un plateau vide entouré de murs
+* @param plat de type *t_plateau : le plateau à initialiser
+* @param largeur de type int : le nombre de colonnes
+* @param hauteur de type int : le nombre de lignes
+* @return false si la mémoire manque (plat->cases vaut alors NULL)
+*/
+bool plateau_init(t_plateau *plat, int largeur, int hauteur) {
+    int lignes = hauteur + 2 * BORDURE;
+
+    plat->largeur = largeur;
+    plat->hauteur = hauteur;
+    plat->pas = largeur + 2 * BORDURE;
+    plat->voisin[DIR_HAUT] = -plat->pas;
+    plat->voisin[DIR_BAS] = plat->pas;
+    plat->voisin[DIR_GAUCHE] = -1;
+    plat->voisin[DIR_DROITE] = 1;
+    plat->cibles = 0;
+    plat->mortes = 0;
+    plat->figes = 0;
+    plat->empreinte = 0;
+    plat->cases = malloc((size_t)lignes * (size_t)plat->pas);
+    if (plat->cases == NULL) {
+        return false;
+    }
+    memset(plat->cases, CASE_MUR, (size_t)lignes * (size_t)plat->pas);
+    for (int i = 0; i < hauteur; i++) {
+        memset(plat->cases + plateau_indice(plat, i, 0), CASE_VIDE, 
+            (size_t)largeur);
+    }
+    return true;
+}
+
+
+/**
+* @brief Libère les cases du plateau
+* @param plat de type *t_plateau : le plateau de jeu
+*/
+void plateau_liberer(t_plateau *plat) {
+    free(plat->cases);
+    plat->cases = NULL;
+}
+
+
+/**
+* @brief Copie un plateau (l'ancien contenu de la copie est libéré)
+* @param dest de type *t_plateau : la copie
+* @param src de type *t_plateau : le plateau à copier
+* @return false si la mémoire manque (dest->cases vaut alors NULL)
+*/
+bool plateau_copier(t_plateau *dest, t_plateau *src) {
+    size_t total = (size_t)(src->hauteur + 2 * BORDURE) * (size_t)src->pas;
+    uint8_t *cases = dest->cases;
+
+    if (cases == NULL || dest->largeur != src->largeur || 
+        dest->hauteur != src->hauteur) {
+        free(cases);
+        cases = malloc(total);
+        if (cases == NULL) {
+            dest->cases = NULL;
+            return false;
+        }
+    }
+    *dest = *src;
+    dest->cases = cases;
+    memcpy(dest->cases, src->cases, total);
+    return true;
+}
+
+
+/**
+* @brief Recherche et initialise la position du joueur
+* @param plat de type *t_plateau : le plateau de jeu
+* @param joueur de type *int : l'indice de la case du joueur (sera modifié)
+*/
+void cherche_joueur(t_plateau *plat, int *joueur) {
+    int total = (plat->hauteur + 2 * BORDURE) * plat->pas;
+    for (int k = 0; k < total; k++) {
+        if ( plat->cases[k] & CASE_JOUEUR ) {
+            *joueur = k;
+        }
+    }
+}
+
+
+/**
+* @brief Convertit un caractère du format .sok en case
+* @param c de type char : le caractère lu
+* @return la combinaison de bits CASE_* (vide si le caractère est inconnu)
+*/
+uint8_t car_vers_case(char c) {
+    uint8_t res = CASE_VIDE;
+    switch (c) {
+        case MUR: res = CASE_MUR; break;
+        case CIBLE: res = CASE_CIBLE; break;
+        case CAISSE: res = CASE_CAISSE; break;
+        case CAISSE_CIBLE: res = CASE_CAISSE | CASE_CIBLE; break;
+        case SOKOBAN: res = CASE_JOUEUR; break;
+        case SOKOBAN_CIBLE: res = CASE_JOUEUR | CASE_CIBLE; break;
+    }
+    return res;
+}
+
+
+/**
+* @brief Convertit une case en caractère du format .sok
+* @param c de type uint8_t : la combinaison de bits CASE_*
+* @return le caractère à enregistrer
+*/
+char case_vers_car(uint8_t c) {
+    static const char car[16] = {
+        VIDE, MUR, CAISSE, MUR, CIBLE, MUR, CAISSE_CIBLE, MUR,
+        SOKOBAN, MUR, SOKOBAN, MUR, SOKOBAN_CIBLE, MUR, SOKOBAN_CIBLE, MUR
+    };
+    return car[c & 15];
+}
+
+
+/**
+* @brief Teste si un carré de 2x2 cases est figé : uniquement des murs et
+* des caisses, dont au moins une hors cible, qui ne pourra plus bouger
+* @param plat de type *t_plateau : le plateau de jeu
+* @param coin de type int : la case en haut à gauche du carré
+* @return 1 si le carré est figé, 0 sinon
+*/
+static int carre_fige(t_plateau *plat, int coin) {
+    uint8_t carre[4] = { plat->cases[coin], plat->cases[coin + 1],
+        plat->cases[coin + plat->pas], plat->cases[coin + plat->pas + 1] };
+    int horsCible = 0;
+
+    for (int k = 0; k < 4; k++) {
+        if ((carre[k] & CASE_BLOQUE) == 0) {
+            return 0;
+        }
+        horsCible |= (carre[k] & (CASE_CAISSE | CASE_CIBLE)) == CASE_CAISSE;
+    }
+    return horsCible;
+}
+
+
+/**
+* @brief Compte les carrés figés qui contiennent l'une de deux cases
+* voisines (les carrés communs ne sont comptés qu'une fois)
+* @param plat de type *t_plateau : le plateau de jeu
+* @param a de type int : la première case
+* @param b de type int : la seconde case
+* @return le nombre de carrés figés
+*/
+static int figes_autour(t_plateau *plat, int a, int b) {
+    int coins[8] = { a, a - 1, a - plat->pas, a - plat->pas - 1,
+                     b, b - 1, b - plat->pas, b - plat->pas - 1 };
+    int n = 0;
+
+    for (int k = 0; k < 8; k++) {
+        bool compte = false;
+        for (int m = 0; m < 4 && k >= 4; m++) {
+            compte = compte || coins[m] == coins[k];
+        }
+        if (!compte) {
+            n += carre_fige(plat, coins[k]);
+        }
+    }
+    return n;
+}
+
+
+/**
+* @brief Tente de déplacer une caisse si possible ; tient à jour les
+* compteurs de cibles libres et d'impasses (case morte, carré figé)
+* @param plat de type *t_plateau : le plateau de jeu
+* @param caisse de type int : la case où se trouve la caisse (future position Sokoban)
+* @param decalage de type int : le décalage d'indice de la direction
+* @return true si la caisse a été déplacée, false sinon (mur ou autre caisse)
+*/
+bool depl_case(t_plateau *plat, int caisse, int decalage) {
+    int dest = caisse + decalage;
+    uint8_t d = plat->cases[dest];
+    int figes;
+    
+    if (d & CASE_BLOQUE) {
+        return false;
+    }
+    figes = figes_autour(plat, caisse, dest);
+    plat->cases[caisse] &= (uint8_t)~CASE_CAISSE;
+    plat->cases[dest] = d | CASE_CAISSE;
+    // la caisse libère éventuellement sa cible et en couvre peut-être une autre
+    plat->cibles += ((plat->cases[caisse] & CASE_CIBLE) - (d & CASE_CIBLE)) / CASE_CIBLE;
+    plat->mortes += ((d & CASE_MORTE) - (plat->cases[caisse] & CASE_MORTE)) / CASE_MORTE;
+    plat->figes += figes_autour(plat, caisse, dest) - figes;
+    return true;
+}
+
+
+/**
+* @brief Met à jour le plateau de jeu après un déplacement réussi du Sokoban
+* @param plat de type *t_plateau : le plateau de jeu
+* @param joueur de type int : l'ancienne case du Sokoban
+* @param suivant de type int : la nouvelle case du Sokoban
+*/
+void mettre_a_jour_plateau(t_plateau *plat, int joueur, int suivant) {
+    plat->cases[joueur] &= (uint8_t)~CASE_JOUEUR;
+    plat->cases[suivant] |= CASE_JOUEUR;
+}
+
+
+/**
+* @brief Détermine la direction pour la touche donnée
+* @param direct de type char : direction
+* @param dir de type *int : indice de la direction (DIR_HAUT...)
+* @return true si la direction est reconnue, false sinon
+*/
+bool deter_direct_code(char direct, int *dir) {
+    bool var = true;
+    switch (direct) {
+        case HAUT:
+            *dir = DIR_HAUT;
+            break;
+        case GAUCHE:
+            *dir = DIR_GAUCHE;
+            break;
+        case BAS:
+            *dir = DIR_BAS;
+            break;
+        case DROITE:
+            *dir = DIR_DROITE;
+            break;
+        default:
+            var = false;
+    }
+    return var;
+}
+
+
+/**
+* @brief Joue un coup sur le plateau, sans l'enregistrer
+* @param plat de type *t_plateau : le plateau de jeu
+* @param joueur de type *int : la case du joueur (mise à jour)
+* @param dir de type int : la direction (DIR_*)
+* @return le coup joué (dir, plus COUP_POUSSEE si une caisse a été
+* poussée) ou -1 si le coup est impossible
+*/
+int jouer_coup(t_plateau *plat, int *joueur, int dir) {
+    int decalage = plat->voisin[dir];
+    int suivant = *joueur + decalage;
+    uint8_t c = plat->cases[suivant];
+    int coup = dir;
+
+    if (c & CASE_MUR) {
+        return -1;
+    }
+    if (c & CASE_CAISSE) {
+        if (!depl_case(plat, suivant, decalage)) {
+            return -1;
+        }
+        coup |= COUP_POUSSEE;
+    }
+    mettre_a_jour_plateau(plat, *joueur, suivant);
+    *joueur = suivant;
+    return coup;
+}
+
+
+/**
+* @brief Annule un coup joué par jouer_coup()
+* @param plat de type *t_plateau : le plateau de jeu
+* @param joueur de type *int : la case du joueur (mise à jour)
+* @param coup de type int : le coup à annuler
+*/
+void annuler_coup(t_plateau *plat, int *joueur, int coup) {
+    int decalage = plat->voisin[coup & 3];
+    int pos = *joueur;
+    int precedent = pos - decalage;
+
+    if (coup & COUP_POUSSEE) {
+        int caisse = pos + decalage;
+        int figes = figes_autour(plat, caisse, pos);
+        uint8_t c = plat->cases[caisse] & (uint8_t)~CASE_CAISSE;
+        plat->cases[caisse] = c;
+        plat->cases[pos] |= CASE_CAISSE;
+        plat->cibles += ((c & CASE_CIBLE) - (plat->cases[pos] & CASE_CIBLE)) / CASE_CIBLE;
+        plat->mortes += ((plat->cases[pos] & CASE_MORTE) - (c & CASE_MORTE)) / CASE_MORTE;
+        plat->figes += figes_autour(plat, caisse, pos) - figes;
+    }
+    mettre_a_jour_plateau(plat, pos, precedent);
+    *joueur = precedent;
+}
+
+
+/**
+* @brief Initialise un historique de déplacements vide
+* @param depl de type *t_tab_deplacement : l'historique
+*/
+void depl_init(t_tab_deplacement *depl) {
+    depl->blocs = NULL;
+    depl->nbBlocs = 0;
+    depl->capaBlocs = 0;
+    depl->nb = 0;
+    depl->fin = 0;
+}
+
+
+/**
+* @brief Libère tous les blocs de l'historique
+* @param depl de type *t_tab_deplacement : l'historique
+*/
+void depl_liberer(t_tab_deplacement *depl) {
+    for (int b = 0; b < depl->nbBlocs; b++) {
+        free(depl->blocs[b]);
+    }
+    free(depl->blocs);
+    depl_init(depl);
+}
+
+
+/**
+* @brief Vide l'historique en gardant ses blocs pour la suite de la partie
+* @param depl de type *t_tab_deplacement : l'historique
+*/
+void depl_vider(t_tab_deplacement *depl) {
+    depl->nb = 0;
+    depl->fin = 0;
+}
+
+
+/**
+* @brief Alloue le bloc qui recevra le coup rangé à la place k, sans rien
+* changer aux coups déjà rangés
+* @param depl de type *t_tab_deplacement : l'historique
+* @param k de type long : la place (au plus le nombre de coups rangés)
+* @return false si la mémoire manque
+*/
+bool depl_reserver(t_tab_deplacement *depl, long k) {
+    int b = (int)(k / DEPL_BLOC);
+
+    if (b < depl->nbBlocs) {
+        return true;
+    }
+    if (depl->nbBlocs == depl->capaBlocs) {
+        int capa = (depl->capaBlocs == 0) ? 8 : depl->capaBlocs * 2;
+        uint8_t **blocs = realloc(depl->blocs, (size_t)capa * sizeof(uint8_t *));
+        if (blocs == NULL) {
+            return false;
+        }
+        depl->blocs = blocs;
+        depl->capaBlocs = capa;
+    }
+    // un octet de plus pour lire un coup à cheval sur deux octets
+    depl->blocs[b] = calloc(DEPL_BLOC * DEPL_BITS / 8 + 1, 1);
+    if (depl->blocs[b] == NULL) {
+        return false;
+    }
+    depl->nbBlocs++;
+    return true;
+}
+
+
+/**
+* @brief Range un coup à la place k de l'historique, en allouant son bloc
+* @param depl de type *t_tab_deplacement : l'historique
+* @param k de type long : la place (au plus le nombre de coups rangés)
+* @param coup de type int : le coup (direction | COUP_POUSSEE)
+* @return false si la mémoire manque (l'historique est inchangé)
+*/
+static bool depl_ecrire(t_tab_deplacement *depl, long k, int coup) {
+    long bit = (k % DEPL_BLOC) * DEPL_BITS;
+    uint8_t *bloc;
+    unsigned mot;
+
+    if (!depl_reserver(depl, k)) {
+        return false;
+    }
+    bloc = depl->blocs[k / DEPL_BLOC] + (bit >> 3);
+    mot = (unsigned)bloc[0] | ((unsigned)bloc[1] << 8);
+    mot &= ~(7u << (bit & 7));
+    mot |= ((unsigned)coup & 7u) << (bit & 7);
+    bloc[0] = (uint8_t)mot;
+    bloc[1] = (uint8_t)(mot >> 8);
+    return true;
+}
+
+
+/**
+* @brief Ajoute un coup à la fin de l'historique. Les coups annulés qui
+* pouvaient être refaits sont oubliés, sauf si le coup est justement le
+* prochain à refaire.
+* @param depl de type *t_tab_deplacement : l'historique
+* @param coup de type int : le coup (direction | COUP_POUSSEE)
+* @return false si la mémoire manque (l'historique est inchangé)
+*/
+bool depl_ajouter(t_tab_deplacement *depl, int coup) {
+    if (depl->nb < depl->fin && depl_lire(depl, depl->nb) == coup) {
+        depl->nb++;
+        return true;
+    }
+    if (!depl_ecrire(depl, depl->nb, coup)) {
+        return false;
+    }
+    depl->nb++;
+    depl->fin = depl->nb;
+    return true;
+}
+
+
+/**
+* @brief Ajoute un coup à refaire après les coups déjà rangés
+* @param depl de type *t_tab_deplacement : l'historique
+* @param coup de type int : le coup (direction | COUP_POUSSEE)
+* @return false si la mémoire manque (l'historique est inchangé)
+*/
+bool depl_prolonger(t_tab_deplacement *depl, int coup) {
+    if (!depl_ecrire(depl, depl->fin, coup)) {
+        return false;
+    }
+    depl->fin++;
+    return true;
+}
+
+
+/**
+* @brief Copie un historique, coups à refaire compris
+* @param dest de type *t_tab_deplacement : la copie (initialisée)
+* @param src de type *t_tab_deplacement : l'historique à copier
+* @return false si la mémoire manque
+*/
+bool depl_copier(t_tab_deplacement *dest, t_tab_deplacement *src) {
+    depl_vider(dest);
+    for (int b = 0; b < src->nbBlocs; b++) {
+        if (!depl_reserver(dest, (long)b * DEPL_BLOC)) {
+            return false;
+        }
+        memcpy(dest->blocs[b], src->blocs[b], DEPL_BLOC * DEPL_BITS / 8 + 1);
+    }
+    dest->nb = src->nb;
+    dest->fin = src->fin;
+    return true;
+}
+
+
+/**
+* @brief Lit le k-ième coup de l'historique
+* @param depl de type *t_tab_deplacement : l'historique
+* @param k de type long : le numéro du coup (0 <= k < depl->nb)
+* @return le coup (direction | COUP_POUSSEE)
+*/
+int depl_lire(t_tab_deplacement *depl, long k) {
+    long bit = (k % DEPL_BLOC) * DEPL_BITS;
+    uint8_t *bloc = depl->blocs[k / DEPL_BLOC] + (bit >> 3);
+    unsigned mot = (unsigned)bloc[0] | ((unsigned)bloc[1] << 8);
+    return (int)((mot >> (bit & 7)) & 7u);
+}
+
+
+/**
+* @brief Retire le dernier coup de l'historique
+* @param depl de type *t_tab_deplacement : l'historique (non vide)
+* @return le coup retiré
+*/
+int depl_retirer(t_tab_deplacement *depl) {
+    depl->nb--;
+    return depl_lire(depl, depl->nb);
+}
+
+
+/**
+* @brief Reprend le premier coup annulé de l'historique
+* @param depl de type *t_tab_deplacement : l'historique
+* @return le coup repris, ou -1 s'il n'y a rien à refaire
+*/
+int depl_refaire(t_tab_deplacement *depl) {
+    if (depl->nb >= depl->fin) {
+        return -1;
+    }
+    depl->nb++;
+    return depl_lire(depl, depl->nb - 1);
+}
+
+
+/**
+* @brief Donne le code de déplacement (SOKO_* ou CAISSE_*) d'un coup
+* @param coup de type int : le coup (direction | COUP_POUSSEE)
+* @return le code du déplacement
+*/
+char coup_vers_code(int coup) {
+    static const char codes[8] = {
+        SOKO_HAUT, SOKO_BAS, SOKO_GAUCHE, SOKO_DROITE,
+        CAISSE_HAUT, CAISSE_BAS, CAISSE_GAUCHE, CAISSE_DROITE
+    };
+    return codes[coup & 7];
+}
+
+
+/**
+* @brief Donne le coup correspondant à un code de déplacement
+* @param code de type char : le code (SOKO_* ou CAISSE_*)
+* @return le coup, ou -1 si le code est inconnu
+*/
+int code_vers_coup(char code) {
+    int coup = -1;
+    switch (code) {
+        case SOKO_HAUT: coup = DIR_HAUT; break;
+        case SOKO_BAS: coup = DIR_BAS; break;
+        case SOKO_GAUCHE: coup = DIR_GAUCHE; break;
+        case SOKO_DROITE: coup = DIR_DROITE; break;
+        case CAISSE_HAUT: coup = DIR_HAUT | COUP_POUSSEE; break;
+        case CAISSE_BAS: coup = DIR_BAS | COUP_POUSSEE; break;
+        case CAISSE_GAUCHE: coup = DIR_GAUCHE | COUP_POUSSEE; break;
+        case CAISSE_DROITE: coup = DIR_DROITE | COUP_POUSSEE; break;
+    }
+    return coup;
+}
+
+
+/**
+* @brief Note une case modifiée pour le réaffichage partiel
+* @param modifs de type *t_modifs : les cases modifiées (ignoré si NULL)
+* @param pos de type int : l'indice de la case
+*/
+static void modifs_ajouter(t_modifs *modifs, int pos) {
+    if (modifs != NULL && modifs->n < MODIFS_MAX) {
+        modifs->pos[modifs->n] = pos;
+        modifs->n++;
+    }
+}
+
+
+/**
+* @brief Gère la globalité du déplacement du Sokoban
+* @param plat de type *t_plateau : le plateau de jeu
+* @param depl de type *t_tab_deplacement : l'historique des déplacements
+* @param direct de type char : la direction du déplacement
+* @param joueur de type *int : la case du joueur
+* @param modifs de type *t_modifs : reçoit les cases modifiées (peut être NULL)
+*/
+void deplacer(t_plateau *plat, t_tab_deplacement *depl, char direct, 
+              int *joueur, t_modifs *modifs) {
+    int dir = 0;
+    int avant = *joueur;
+    int coup;
+
+    if (deter_direct_code(direct, &dir)) {
+        coup = jouer_coup(plat, joueur, dir);
+        if (coup >= 0 && !depl_ajouter(depl, coup)) {
+            // faute de mémoire pour l'historique, le coup n'est pas joué
+            annuler_coup(plat, joueur, coup);
+            coup = -1;
+        }
+        if (coup >= 0) {
+            modifs_ajouter(modifs, avant);
+            modifs_ajouter(modifs, *joueur);
+            if (coup & COUP_POUSSEE) {
+                modifs_ajouter(modifs, *joueur + plat->voisin[dir]);
+            }
+        }
+    }
+}
+
+
+/**
+* @brief Effectue l'annulation du dernier déplacement
+* @param plat de type *t_plateau : le plateau de jeu
+* @param depl de type *t_tab_deplacement : l'historique des déplacements
+* @param joueur de type *int : la case actuelle du joueur
+* @param modifs de type *t_modifs : reçoit les cases modifiées (peut être NULL)
+*/
+void undo(t_plateau *plat, t_tab_deplacement *depl, int *joueur,
+    t_modifs *modifs) {
+    if (depl->nb <= 0) {
+        return; 
+    }
+    int coup = depl_retirer(depl);
+    int avant = *joueur;
+    annuler_coup(plat, joueur, coup);
+    if (coup & COUP_POUSSEE) {
+        modifs_ajouter(modifs, avant + plat->voisin[coup & 3]);
+    }
+    modifs_ajouter(modifs, avant);
+    modifs_ajouter(modifs, *joueur);
+}
+
+
+/**
+* @brief Refait le dernier déplacement annulé
+* @param plat de type *t_plateau : le plateau de jeu
+* @param depl de type *t_tab_deplacement : l'historique des déplacements
+* @param joueur de type *int : la case actuelle du joueur
+* @param modifs de type *t_modifs : reçoit les cases modifiées
+*/
+void redo(t_plateau *plat, t_tab_deplacement *depl, int *joueur,
+    t_modifs *modifs) {
+    int coup = depl_refaire(depl);
+    int avant = *joueur;
+
+    if (coup < 0) {
+        return;
+    }
+    jouer_coup(plat, joueur, coup & 3);
+    modifs_ajouter(modifs, avant);
+    modifs_ajouter(modifs, *joueur);
+    if (coup & COUP_POUSSEE) {
+        modifs_ajouter(modifs, *joueur + plat->voisin[coup & 3]);
+    }
+}
+
+
+// Points de contrôle
+
+
+/**
+* @brief Prépare les points de contrôle d'une partie
+* @param points de type *t_points : les points de contrôle
+* @param depart de type *t_plateau : le niveau de départ (point 0)
+* @param joueur de type int : la case de départ du joueur
+* @return false si la mémoire manque pour le point 0
+*/
+bool points_init(t_points *points, t_plateau *depart, int joueur) {
+    points->total = (depart->hauteur + 2 * BORDURE) * depart->pas;
+    points->nb = 0;
+    points->capa = 0;
+    points->cases = NULL;
+    points->etats = NULL;
+    return points_noter(points, depart, joueur, 0);
+}
+
+
+/**
+* @brief Libère les points de contrôle
+* @param points de type *t_points : les points de contrôle
+*/
+void points_liberer(t_points *points) {
+    free(points->cases);
+    free(points->etats);
+    points->cases = NULL;
+    points->etats = NULL;
+    points->nb = 0;
+}
+
+
+/**
+* @brief Copie les points de contrôle d'une partie
+* @param dest de type *t_points : la copie (vide)
+* @param src de type *t_points : les points à copier
+* @return false si la mémoire manque
+*/
+bool points_copier(t_points *dest, t_points *src) {
+    dest->total = src->total;
+    dest->nb = 0;
+    dest->capa = src->nb;
+    dest->cases = malloc((size_t)src->nb * (size_t)src->total);
+    dest->etats = malloc((size_t)src->nb * 4 * sizeof(int));
+    if (dest->cases == NULL || dest->etats == NULL) {
+        return false;
+    }
+    memcpy(dest->cases, src->cases, (size_t)src->nb * (size_t)src->total);
+    memcpy(dest->etats, src->etats, (size_t)src->nb * 4 * sizeof(int));
+    dest->nb = src->nb;
+    return true;
+}
+
+
+/**
+* @brief Note un point de contrôle si la partie vient d'atteindre le
+* coup qui suit le dernier point noté
+* @param points de type *t_points : les points de contrôle
+* @param plat de type *t_plateau : le plateau de jeu
+* @param joueur de type int : la case du joueur
+* @param nb de type long : le nombre de coups joués
+* @return false si la mémoire manque : le point n'est pas noté, il le sera
+* au prochain passage par ce coup
+*/
+bool points_noter(t_points *points, t_plateau *plat, int joueur, long nb) {
+    if (nb != points->nb * POINTS_INTERVALLE) {
+        return true;
+    }
+    if (points->nb == points->capa) {
+        long capa = (points->capa == 0) ? 16 : points->capa * 2;
+        uint8_t *cases = realloc(points->cases, (size_t)capa * (size_t)points->total);
+        if (cases == NULL) {
+            return false;
+        }
+        points->cases = cases;
+        int *etats = realloc(points->etats, (size_t)capa * 4 * sizeof(int));
+        if (etats == NULL) {
+            return false;
+        }
+        points->cases = cases;
+        points->etats = etats;
+        points->capa = capa;
+    }
+    memcpy(points->cases + (size_t)points->nb * (size_t)points->total, 
+        plat->cases, (size_t)points->total);
+    int *etat = points->etats + points->nb * 4;
+    etat[0] = joueur;
+    etat[1] = plat->cibles;
+    etat[2] = plat->mortes;
+    etat[3] = plat->figes;
+    points->nb++;
+    return true;
+}
+
+
+/**
+* @brief Oublie les points de contrôle qui suivent un coup remplacé
+* @param points de type *t_points : les points de contrôle
+* @param coup de type long : le numéro (à partir de 0) du coup qui vient
+* d'être joué à la place d'un coup annulé ou en fin d'historique
+*/
+void points_tronquer(t_points *points, long coup) {
+    long garder = coup / POINTS_INTERVALLE + 1;
+    if (points->nb > garder) {
+        points->nb = garder;
+    }
+}
+
+
+/**
+* @brief Rejoue tout l'historique depuis le niveau de départ pour noter
+* les points de contrôle, par exemple après une reprise de partie
+* @param points de type *t_points : les points de contrôle, dont seul le
+* point 0 est noté
+* @param plat de type *t_plateau : le plateau, au coup depl->nb
+* @param joueur de type *int : la case du joueur
+* @param depl de type *t_tab_deplacement : l'historique
+*/
+void points_reconstruire(t_points *points, t_plateau *plat, int *joueur,
+    t_tab_deplacement *depl) {
+    long nb = depl->nb;
+
+    aller_au_coup(plat, joueur, depl, points, 0);
+    aller_au_coup(plat, joueur, depl, points, nb);
+}
+
+
+/**
+* @brief Amène la partie au coup n de l'historique : depuis le point de
+* contrôle le plus proche, ou depuis la position actuelle si c'est moins
+* de coups à rejouer ou à annuler. Les points manquants sont notés en
+* passant.
+* @param plat de type *t_plateau : le plateau de jeu
+* @param joueur de type *int : la case du joueur
+* @param depl de type *t_tab_deplacement : l'historique
+* @param points de type *t_points : les points de contrôle
+* @param n de type long : le coup visé (ramené entre 0 et depl->fin)
+*/
+void aller_au_coup(t_plateau *plat, int *joueur, t_tab_deplacement *depl,
+    t_points *points, long n) {
+    long point, depuisPoint;
+
+    if (n < 0) {
+        n = 0;
+    }
+    if (n > depl->fin) {
+        n = depl->fin;
+    }
+    point = n / POINTS_INTERVALLE;
+    if (point >= points->nb) {
+        point = points->nb - 1;
+    }
+    depuisPoint = n - point * POINTS_INTERVALLE;
+
+    if (n <= depl->nb && depl->nb - n <= depuisPoint) {
+        while (depl->nb > n) {
+            annuler_coup(plat, joueur, depl_retirer(depl));
+        }
+        return;
+    }
+    if (n < depl->nb || n - depl->nb > depuisPoint) {
+        int *etat = points->etats + point * 4;
+        memcpy(plat->cases, points->cases + (size_t)point * (size_t)points->total,
+            (size_t)points->total);
+        *joueur = etat[0];
+        plat->cibles = etat[1];
+        plat->mortes = etat[2];
+        plat->figes = etat[3];
+        depl->nb = point * POINTS_INTERVALLE;
+    }
+    while (depl->nb < n) {
+        jouer_coup(plat, joueur, depl_refaire(depl) & 3);
+        points_noter(points, plat, *joueur, depl->nb);
+    }
+}
+
+
+// Arbre des parties
+
+
+/**
+* @brief Crée un coup de l'arbre, sans fils ni frère
+* @param arbre de type *t_arbre : l'arbre des parties
+* @param coup de type int : le coup joué pour l'atteindre
+* @return l'indice du nouveau coup, -1 si la mémoire manque
+*/
+static int32_t arbre_noeud(t_arbre *arbre, int coup) {
+    if (arbre->nb == arbre->capa) {
+        int32_t capa = (arbre->capa == 0) ? 1024 : arbre->capa * 2;
+        t_noeud_coup *noeuds = realloc(arbre->noeuds, (size_t)capa * sizeof(t_noeud_coup));
+        if (noeuds == NULL) {
+            return -1;
+        }
+        arbre->noeuds = noeuds;
+        arbre->capa = capa;
+    }
+    arbre->noeuds[arbre->nb].premier = -1;
+    arbre->noeuds[arbre->nb].frere = -1;
+    arbre->noeuds[arbre->nb].coup = (uint8_t)coup;
+    return arbre->nb++;
+}
+
+
+/**
+* @brief Range le coup atteint après k coups de la ligne suivie
+* @param arbre de type *t_arbre : l'arbre des parties
+* @param k de type long : le nombre de coups
+* @param noeud de type int32_t : le coup atteint
+* @return false si la mémoire manque
+*/
+static bool arbre_ligne(t_arbre *arbre, long k, int32_t noeud) {
+    if (k == arbre->capaLigne) {
+        long capa = (arbre->capaLigne == 0) ? 1024 : arbre->capaLigne * 2;
+        int32_t *ligne = realloc(arbre->ligne, (size_t)capa * sizeof(int32_t));
+        if (ligne == NULL) {
+            return false;
+        }
+        arbre->ligne = ligne;
+        arbre->capaLigne = capa;
+    }
+    arbre->ligne[k] = noeud;
+    return true;
+}
+
+
+/**
+* @brief Réserve la place de nouveaux coups dans l'arbre et celle des
+* coups de la ligne suivie jusqu'au coup k, pour qu'arbre_jouer() ne
+* puisse pas échouer en route
+* @param arbre de type *t_arbre : l'arbre des parties
+* @param k de type long : le nombre de coups après les prochains coups
+* @param nouveaux de type int32_t : le nombre de coups à jouer
+* @return false si la mémoire manque
+*/
+bool arbre_reserver(t_arbre *arbre, long k, int32_t nouveaux) {
+    int32_t nb = arbre->nb;
+
+    for (int32_t m = 0; m < nouveaux; m++) {
+        if (arbre_noeud(arbre, 0) < 0) {
+            arbre->nb = nb;
+            return false;
+        }
+    }
+    arbre->nb = nb;
+    while (k >= arbre->capaLigne) {
+        if (!arbre_ligne(arbre, arbre->capaLigne, -1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+* @brief Réécrit la fin de l'historique à partir du coup depl->nb en
+* suivant les premiers fils de l'arbre
+* @param arbre de type *t_arbre : l'arbre des parties
+* @param depl de type *t_tab_deplacement : l'historique
+* @return false si la mémoire manque : les coups à refaire s'arrêtent
+* alors avant la fin de la variante, qui reste dans l'arbre
+*/
+static bool arbre_suivre(t_arbre *arbre, t_tab_deplacement *depl) {
+    int32_t n = arbre->noeuds[arbre->ligne[depl->nb]].premier;
+
+    depl->fin = depl->nb;
+    while (n >= 0) {
+        if (!arbre_ligne(arbre, depl->fin + 1, n) || 
+            !depl_prolonger(depl, arbre->noeuds[n].coup)) {
+            return false;
+        }
+        n = arbre->noeuds[n].premier;
+    }
+    return true;
+}
+
+
+/**
+* @brief Met un fils en tête de la liste de son parent : il devient la
+* variante suivie
+* @param arbre de type *t_arbre : l'arbre des parties
+* @param parent de type int32_t : le parent
+* @param fils de type int32_t : le fils, déjà dans la liste ou nouveau
+*/
+static void arbre_en_tete(t_arbre *arbre, int32_t parent, int32_t fils) {
+    int32_t *lien = &arbre->noeuds[parent].premier;
+
+    while (*lien >= 0 && *lien != fils) {
+        lien = &arbre->noeuds[*lien].frere;
+    }
+    if (*lien == fils) {
+        *lien = arbre->noeuds[fils].frere;
+    }
+    arbre->noeuds[fils].frere = arbre->noeuds[parent].premier;
+    arbre->noeuds[parent].premier = fils;
+}
+
+
+/**
+* @brief Construit l'arbre d'une partie dont l'historique n'a qu'une ligne
+* (nouvelle partie ou partie reprise)
+* @param arbre de type *t_arbre : l'arbre à construire
+* @param depl de type *t_tab_deplacement : l'historique
+* @return false si la mémoire manque (l'arbre reste à libérer)
+*/
+bool arbre_init(t_arbre *arbre, t_tab_deplacement *depl) {
+    int32_t parent;
+
+    arbre->noeuds = NULL;
+    arbre->nb = 0;
+    arbre->capa = 0;
+    arbre->ligne = NULL;
+    arbre->capaLigne = 0;
+    parent = arbre_noeud(arbre, 0);
+    if (parent < 0 || !arbre_ligne(arbre, 0, parent)) {
+        return false;
+    }
+    for (long k = 0; k < depl->fin; k++) {
+        int32_t n = arbre_noeud(arbre, depl_lire(depl, k));
+        if (n < 0 || !arbre_ligne(arbre, k + 1, n)) {
+            return false;
+        }
+        arbre->noeuds[parent].premier = n;
+        parent = n;
+    }
+    return true;
+}
+
+
+/**
+* @brief Libère l'arbre des parties
+* @param arbre de type *t_arbre : l'arbre des parties
+*/
+void arbre_liberer(t_arbre *arbre) {
+    free(arbre->noeuds);
+    free(arbre->ligne);
+    arbre->noeuds = NULL;
+    arbre->ligne = NULL;
+    arbre->nb = 0;
+}
+
+
+/**
+* @brief Copie l'arbre des parties, sans la place libre de l'original :
+* une partie clonée qui n'est pas jouée coûte le moins possible
+* @param dest de type *t_arbre : la copie (vide)
+* @param src de type *t_arbre : l'arbre à copier
+* @return false si la mémoire manque
+*/
+bool arbre_copier(t_arbre *dest, t_arbre *src) {
+    // la ligne suivie passe par des coups distincts : au plus nb coups
+    long ligne = (src->capaLigne < src->nb) ? src->capaLigne : src->nb;
+
+    dest->nb = 0;
+    dest->capa = 0;
+    dest->capaLigne = 0;
+    dest->noeuds = malloc((size_t)src->nb * sizeof(t_noeud_coup));
+    dest->ligne = malloc((size_t)ligne * sizeof(int32_t));
+    if (dest->noeuds == NULL || dest->ligne == NULL) {
+        return false;
+    }
+    memcpy(dest->noeuds, src->noeuds, (size_t)src->nb * sizeof(t_noeud_coup));
+    memcpy(dest->ligne, src->ligne, (size_t)ligne * sizeof(int32_t));
+    dest->nb = src->nb;
+    dest->capa = src->nb;
+    dest->capaLigne = ligne;
+    return true;
+}
+
+
+/**
+* @brief Range dans l'arbre le coup que deplacer() vient d'ajouter à
+* l'historique. Si ce coup avait déjà été joué depuis cette position, sa
+* variante redevient la ligne suivie et peut être refaite.
+* La place du coup doit avoir été réservée par arbre_reserver() ; si la
+* mémoire manque pour réécrire les coups à refaire, ils sont écourtés.
+* @param arbre de type *t_arbre : l'arbre des parties
+* @param depl de type *t_tab_deplacement : l'historique
+* @return true si la fin de la ligne suivie a changé
+*/
+bool arbre_jouer(t_arbre *arbre, t_tab_deplacement *depl) {
+    int32_t parent = arbre->ligne[depl->nb - 1];
+    int coup = depl_lire(depl, depl->nb - 1);
+    int32_t n = arbre->noeuds[parent].premier;
+
+    if (n >= 0 && arbre->noeuds[n].coup == coup) {
+        // le prochain coup à refaire : depl_ajouter() a gardé la ligne
+        return false;
+    }
+    while (n >= 0 && arbre->noeuds[n].coup != coup) {
+        n = arbre->noeuds[n].frere;
+    }
+    if (n < 0) {
+        n = arbre_noeud(arbre, coup);
+    }
+    arbre_en_tete(arbre, parent, n);
+    arbre_ligne(arbre, depl->nb, n);
+    arbre_suivre(arbre, depl);
+    return true;
+}
+
+
+/**
+* @brief Donne les variantes jouées depuis la position actuelle
+* @param arbre de type *t_arbre : l'arbre des parties
+* @param depl de type *t_tab_deplacement : l'historique
+* @param coups de type int[4] : reçoit le premier coup de chaque variante
+* @param longueurs de type long[4] : reçoit le nombre de coups de chaque
+* variante, en suivant ses premiers fils
+* @return le nombre de variantes, la première étant la ligne suivie
+*/
+int arbre_branches(t_arbre *arbre, t_tab_deplacement *depl, int coups[4],
+    long longueurs[4]) {
+    int nb = 0;
+
+    for (int32_t f = arbre->noeuds[arbre->ligne[depl->nb]].premier; f >= 0; 
+        f = arbre->noeuds[f].frere) {
+        coups[nb] = arbre->noeuds[f].coup;
+        longueurs[nb] = 0;
+        for (int32_t n = f; n >= 0; n = arbre->noeuds[n].premier) {
+            longueurs[nb]++;
+        }
+        nb++;
+    }
+    return nb;
+}
+
+
+/**
+* @brief Fait d'une variante de la position actuelle la ligne suivie : ses
+* coups sont ceux que refaire (ou aller_au_coup()) rejouera. Le plateau ne
+* change pas.
+* @param arbre de type *t_arbre : l'arbre des parties
+* @param depl de type *t_tab_deplacement : l'historique
+* @param k de type int : le numéro de la variante (voir arbre_branches())
+* @return false si la mémoire manque (voir arbre_suivre())
+*/
+bool arbre_choisir(t_arbre *arbre, t_tab_deplacement *depl, int k) {
+    int32_t parent = arbre->ligne[depl->nb];
+    int32_t n = arbre->noeuds[parent].premier;
+
+    while (k > 0 && n >= 0) {
+        n = arbre->noeuds[n].frere;
+        k--;
+    }
+    if (n < 0) {
+        return true;
+    }
+    arbre_en_tete(arbre, parent, n);
+    return arbre_suivre(arbre, depl);
+}
+
+
+/**
+* @brief Compte les cibles qui ne sont pas couvertes par une caisse
+* @param plat de type *t_plateau : le plateau de jeu
+* @return le nombre de cibles libres
+*/
+int compter_cibles(t_plateau *plat) {
+	int n = 0;
+	int total = (plat->hauteur + 2 * BORDURE) * plat->pas;
+	for(int k=0; k < total; k++){
+		if((plat->cases[k] & (CASE_CIBLE | CASE_CAISSE)) == CASE_CIBLE) {
+			n++;
+		}
+	}
+	return n;
+}
+
+
+/**
+* @brief Vérifie si le joueur a gagné ou non
+* @param plat de type *t_plateau : le plateau de jeu, dont le nombre de
+* cibles sans caisse est tenu à jour par les déplacements
+* @return un booléen : true si gagné et false sinon
+*/
+bool gagne(t_plateau *plat) {
+	return plat->cibles == 0;
+}
+
+
+/**
+* @brief Analyse un niveau qui vient d'être chargé : marque CASE_MORTE les
+* cases d'où une caisse ne peut atteindre aucune cible, puis compte les
+* caisses sur ces cases et les carrés figés.
+* Les cases vivantes sont trouvées en tirant une caisse depuis chaque
+* cible (une poussée à l'envers), sans tenir compte des autres caisses.
+* @param plat de type *t_plateau : le plateau de jeu
+* @return false si la mémoire manque (les compteurs d'impasses restent nuls)
+*/
+bool analyser_niveau(t_plateau *plat) {
+	int total = (plat->hauteur + 2 * BORDURE) * plat->pas;
+	int *file = malloc((size_t)total * sizeof(int));
+	uint8_t *vivante = calloc((size_t)total, 1);
+	int debut = 0, fin = 0;
+
+	plat->mortes = 0;
+	plat->figes = 0;
+	if (file == NULL || vivante == NULL) {
+		free(file);
+		free(vivante);
+		return false;
+	}
+	for (int k = 0; k < total; k++) {
+		if (plat->cases[k] & CASE_CIBLE) {
+			vivante[k] = 1;
+			file[fin++] = k;
+		}
+	}
+	while (debut < fin) {
+		int k = file[debut++];
+		for (int d = 0; d < NB_DIRECTIONS; d++) {
+			// la caisse tirée vient en v, le joueur recule en v + voisin
+			int v = k + plat->voisin[d];
+			if (!vivante[v] && !(plat->cases[v] & CASE_MUR) && 
+				!(plat->cases[v + plat->voisin[d]] & CASE_MUR)) {
+				vivante[v] = 1;
+				file[fin++] = v;
+			}
+		}
+	}
+	for (int k = 0; k < total; k++) {
+		plat->cases[k] &= (uint8_t)~CASE_MORTE;
+		if (!vivante[k] && !(plat->cases[k] & CASE_MUR)) {
+			plat->cases[k] |= CASE_MORTE;
+			plat->mortes += (plat->cases[k] & CASE_CAISSE) != 0;
+		}
+	}
+	for (int k = 0; k + plat->pas + 1 < total; k++) {
+		plat->figes += carre_fige(plat, k);
+	}
+	free(file);
+	free(vivante);
+	return true;
+}
+
+
+/**
+* @brief Indique si la partie ne peut plus être gagnée : une caisse est
+* sur une case morte ou bloquée dans un carré figé
+* @param plat de type *t_plateau : le plateau de jeu
+* @return true si la partie est perdue
+*/
+bool en_impasse(t_plateau *plat) {
+	return plat->mortes > 0 || plat->figes > 0;
+}
+
+
+// Lecture des niveaux
+
+
+/**
+* @brief Donne la longueur utile d'une ligne de texte, sans les blancs
+* ni le retour chariot de fin de ligne
+* @param ligne de type *char : le début de la ligne
+* @param longueur de type size_t : la longueur jusqu'au '\n' exclu
+* @return la longueur utile
+*/
+int longueur_utile(const char *ligne, size_t longueur) {
+    while (longueur > 0 && (ligne[longueur - 1] == VIDE || 
+           ligne[longueur - 1] == '\r')) {
+        longueur--;
+    }
+    return (int)longueur;
+}
+
+
+/**
+* @brief Construit un plateau à partir du texte d'un niveau, lu en place
+* (le texte peut être une projection mémoire en lecture seule)
+* @param plateau de type *t_plateau : le plateau (l'ancien contenu est libéré)
+* @param texte de type *char : le texte du niveau
+* @param taille de type size_t : sa longueur
+* Les lignes peuvent être de longueurs différentes (les cases manquantes
+* sont vides) et les lignes vides en fin de texte sont ignorées.
+* @return false si la mémoire manque
+*/
+bool plateau_depuis_texte(t_plateau *plateau, const char *texte, size_t taille) {
+    int largeur = 0, hauteur = 0, lignesUtiles = 0;
+    int longueur;
+    size_t debut;
+
+    // Premier passage : dimensions (sans les blancs de fin de ligne)
+    debut = 0;
+    for (size_t k = 0; k <= taille; k++) {
+        if (k == taille || texte[k] == '\n') {
+            longueur = longueur_utile(texte + debut, k - debut);
+            hauteur++;
+            if (longueur > 0) {
+                lignesUtiles = hauteur;
+                if (longueur > largeur) {
+                    largeur = longueur;
+                }
+            }
+            debut = k + 1;
+        }
+    }
+
+    // Second passage : copie des lignes dans le plateau
+    plateau_liberer(plateau);
+    if (!plateau_init(plateau, largeur, lignesUtiles)) {
+        return false;
+    }
+    debut = 0;
+    hauteur = 0;
+    for (size_t k = 0; k <= taille && hauteur < lignesUtiles; k++) {
+        if (k == taille || texte[k] == '\n') {
+            longueur = longueur_utile(texte + debut, k - debut);
+            uint8_t *ligne = plateau->cases + plateau_indice(plateau, hauteur, 0);
+            for (int j = 0; j < longueur; j++) {
+                ligne[j] = car_vers_case(texte[debut + j]);
+            }
+            hauteur++;
+            debut = k + 1;
+        }
+    }
+    plateau->cibles = compter_cibles(plateau);
+    plateau->empreinte = empreinte_plateau(plateau);
+    return analyser_niveau(plateau);
+}
+
+
+// Empreintes et entiers
+
+
+/**
+* @brief Calcule l'empreinte d'un plateau (FNV-1a sur les dimensions et
+* le contenu des cases), qui identifie le niveau dans un journal
+* @param plat de type *t_plateau : le plateau, tel que chargé
+* @return l'empreinte sur 64 bits
+*/
+uint64_t empreinte_plateau(t_plateau *plat) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    int dims[2] = { plat->largeur, plat->hauteur };
+
+    for (int k = 0; k < 2; k++) {
+        for (int o = 0; o < 4; o++) {
+            h = (h ^ (uint8_t)(dims[k] >> (8 * o))) * 0x100000001B3ull;
+        }
+    }
+    for (int i = 0; i < plat->hauteur; i++) {
+        uint8_t *ligne = plat->cases + plateau_indice(plat, i, 0);
+        for (int j = 0; j < plat->largeur; j++) {
+            h = (h ^ (ligne[j] & (CASE_MUR | CASE_CAISSE | CASE_CIBLE | 
+                CASE_JOUEUR))) * 0x100000001B3ull;
+        }
+    }
+    return h;
+}
+
+
+/**
+* @brief Écrit un entier en petit-boutiste
+* @param p de type *uint8_t : la destination
+* @param v de type uint64_t : la valeur
+* @param octets de type int : la taille de l'entier
+*/
+void ecrire_entier(uint8_t *p, uint64_t v, int octets) {
+    for (int k = 0; k < octets; k++) {
+        p[k] = (uint8_t)(v >> (8 * k));
+    }
+}
+
+
+/**
+* @brief Lit un entier en petit-boutiste
+* @param p de type *uint8_t : la source
+* @param octets de type int : la taille de l'entier
+* @return la valeur
+*/
+uint64_t lire_entier(const uint8_t *p, int octets) {
+    uint64_t v = 0;
+    for (int k = 0; k < octets; k++) {
+        v |= (uint64_t)p[k] << (8 * k);
+    }
+    return v;
+}
+
+
+// Sauvegarde en mémoire
+
+
+/**
+* @brief Calcule la somme de contrôle d'une sauvegarde (FNV-1a), le champ
+* de la somme étant compté comme nul
+* @param donnees de type *uint8_t : le contenu du fichier
+* @param taille de type size_t : sa taille
+* @return la somme sur 64 bits
+*/
+static uint64_t somme_sauvegarde(const uint8_t *donnees, size_t taille) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t k = 0; k < taille; k++) {
+        bool champ = k >= SAUVEGARDE_POS_SOMME && k < SAUVEGARDE_POS_SOMME + 8;
+        h = (h ^ (champ ? 0 : donnees[k])) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+
+/**
+* @brief Remplit un plateau avec les cases d'une sauvegarde
+* @param plat de type *t_plateau : le plateau (l'ancien contenu est libéré)
+* @param cases de type *uint8_t : les cases, ligne par ligne
+* @param largeur de type int : le nombre de colonnes
+* @param hauteur de type int : le nombre de lignes
+* @return false si la mémoire manque
+*/
+static bool plateau_depuis_cases(t_plateau *plat, const uint8_t *cases, 
+    int largeur, int hauteur) {
+    plateau_liberer(plat);
+    if (!plateau_init(plat, largeur, hauteur)) {
+        return false;
+    }
+    for (int i = 0; i < hauteur; i++) {
+        memcpy(plat->cases + plateau_indice(plat, i, 0), 
+            cases + (size_t)i * (size_t)largeur, (size_t)largeur);
+    }
+    plat->cibles = compter_cibles(plat);
+    return analyser_niveau(plat);
+}
+
+
+// Parties
+
+
+/**
+* @brief Alloue une partie vide : plateaux, historique, points et arbre
+* sans contenu, prêts à être libérés par sokoban_liberer()
+* @return la partie, NULL si la mémoire manque
+*/
+static t_sokoban *partie_nouvelle() {
+    t_sokoban *partie = calloc(1, sizeof(t_sokoban));
+
+    if (partie != NULL) {
+        partie->plat.cases = NULL;
+        partie->depart.cases = NULL;
+        depl_init(&partie->depl);
+        partie->points.cases = NULL;
+        partie->points.etats = NULL;
+        partie->arbre.noeuds = NULL;
+        partie->arbre.ligne = NULL;
+        partie->vus = NULL;
+        partie->file = NULL;
+        partie->venue = NULL;
+    }
+    return partie;
+}
+
+
+/**
+* @brief Rend une partie qui vient d'être construite, ou la libère si la
+* construction a échoué
+* @param partie de type *t_sokoban : la partie (peut être NULL)
+* @param res de type int : SOKOBAN_OK ou le code d'erreur
+* @param erreur de type *int : reçoit res (ignoré si NULL)
+* @return la partie, NULL en cas d'erreur
+*/
+static t_sokoban *partie_rendre(t_sokoban *partie, int res, int *erreur) {
+    if (erreur != NULL) {
+        *erreur = res;
+    }
+    if (res != SOKOBAN_OK) {
+        sokoban_liberer(partie);
+        return NULL;
+    }
+    return partie;
+}
+
+
+/**
+* @brief Termine la construction d'une partie dont le niveau de départ,
+* le plateau, la case du joueur et l'historique sont en place : cherche
+* le joueur au départ, note les points de contrôle et construit l'arbre
+* @param partie de type *t_sokoban : la partie
+* @return SOKOBAN_OK, SOKOBAN_INVALIDE si le niveau n'a pas de joueur ou
+* SOKOBAN_ERREUR_MEMOIRE
+*/
+static int partie_demarrer(t_sokoban *partie) {
+    partie->joueurDepart = -1;
+    cherche_joueur(&partie->depart, &partie->joueurDepart);
+    if (partie->joueurDepart < 0 || partie->joueur < 0) {
+        return SOKOBAN_INVALIDE;
+    }
+    if (!points_init(&partie->points, &partie->depart, partie->joueurDepart) ||
+        !arbre_init(&partie->arbre, &partie->depl)) {
+        return SOKOBAN_ERREUR_MEMOIRE;
+    }
+    if (partie->depl.nb > 0) {
+        points_reconstruire(&partie->points, &partie->plat, &partie->joueur,
+            &partie->depl);
+    }
+    return SOKOBAN_OK;
+}
+
+
+/**
+* @brief Commence une nouvelle partie sur le plateau déjà en place
+* @param partie de type *t_sokoban : la partie
+* @return SOKOBAN_OK ou le code d'erreur (voir partie_demarrer())
+*/
+static int partie_commencer(t_sokoban *partie) {
+    if (!plateau_copier(&partie->depart, &partie->plat)) {
+        return SOKOBAN_ERREUR_MEMOIRE;
+    }
+    partie->joueur = -1;
+    cherche_joueur(&partie->plat, &partie->joueur);
+    return partie_demarrer(partie);
+}
+
+
+/**
+* @brief Crée une partie sur un niveau déjà chargé (le plateau est copié)
+* @param plat de type *t_plateau : le niveau
+* @param erreur de type *int : reçoit SOKOBAN_OK ou le code d'erreur
+* @return la partie, NULL en cas d'erreur
+*/
+t_sokoban *partie_creer(t_plateau *plat, int *erreur) {
+    t_sokoban *partie = partie_nouvelle();
+    int res = SOKOBAN_ERREUR_MEMOIRE;
+
+    if (partie != NULL && plateau_copier(&partie->plat, plat)) {
+        res = partie_commencer(partie);
+    }
+    return partie_rendre(partie, res, erreur);
+}
+
+
+/**
+* @brief Crée une partie à partir du texte d'un niveau .sok
+* @param texte de type *char : le texte du niveau (lu en place)
+* @param taille de type size_t : sa longueur
+* @param erreur de type *int : reçoit SOKOBAN_OK ou le code d'erreur
+* @return la partie, NULL en cas d'erreur
+*/
+t_sokoban *sokoban_charger(const char *texte, size_t taille, int *erreur) {
+    t_sokoban *partie = partie_nouvelle();
+    int res = SOKOBAN_ERREUR_MEMOIRE;
+
+    if (partie != NULL && plateau_depuis_texte(&partie->plat, texte, taille)) {
+        res = partie_commencer(partie);
+    }
+    return partie_rendre(partie, res, erreur);
+}
+
+
+/**
+* @brief Rejoue l'historique d'une sauvegarde depuis le niveau de départ
+* et vérifie qu'il mène au plateau et à la case du joueur enregistrés
+* @param partie de type *t_sokoban : la partie en cours de reprise
+* @return SOKOBAN_OK, SOKOBAN_INVALIDE si un coup est illégal ou si le
+* plateau obtenu n'est pas celui de la sauvegarde, SOKOBAN_ERREUR_MEMOIRE
+*/
+static int partie_verifier(t_sokoban *partie) {
+    t_plateau plat;
+    int joueur = -1;
+    int res = SOKOBAN_OK;
+
+    plat.cases = NULL;
+    if (!plateau_copier(&plat, &partie->depart)) {
+        return SOKOBAN_ERREUR_MEMOIRE;
+    }
+    cherche_joueur(&plat, &joueur);
+    if (joueur < 0) {
+        res = SOKOBAN_INVALIDE;
+    }
+    for (long k = 0; res == SOKOBAN_OK && k < partie->depl.nb; k++) {
+        int coup = depl_lire(&partie->depl, k);
+        if (jouer_coup(&plat, &joueur, coup & 3) != coup) {
+            res = SOKOBAN_INVALIDE;
+        }
+    }
+    if (joueur != partie->joueur) {
+        res = SOKOBAN_INVALIDE;
+    }
+    for (int i = 0; res == SOKOBAN_OK && i < plat.hauteur; i++) {
+        for (int j = 0; j < plat.largeur; j++) {
+            int k = plateau_indice(&plat, i, j);
+            if ((plat.cases[k] ^ partie->plat.cases[k]) & ~CASE_MORTE) {
+                res = SOKOBAN_INVALIDE;
+            }
+        }
+    }
+    plateau_liberer(&plat);
+    return res;
+}
+
+
+/**
+* @brief Reprend une partie enregistrée par sokoban_serialiser() :
+* plateau, case du joueur et historique sont restaurés sans chercher le
+* joueur sur le plateau
+* @param donnees de type *uint8_t : la sauvegarde
+* @param taille de type size_t : sa taille
+* @param erreur de type *int : reçoit SOKOBAN_OK ou le code d'erreur
+* (SOKOBAN_INVALIDE si ce n'est pas une sauvegarde, si elle est corrompue
+* ou si son historique ne mène pas au plateau enregistré)
+* @return la partie, NULL en cas d'erreur
+*/
+t_sokoban *sokoban_restaurer(const uint8_t *donnees, size_t taille,
+    int *erreur) {
+    t_sokoban *partie;
+    const uint8_t *coups;
+    size_t cases;
+    int largeur, hauteur, res;
+    uint64_t l, h, nb;
+
+    if (taille < SAUVEGARDE_ENTETE || memcmp(donnees, SAUVEGARDE_MAGIE, 4) != 0) {
+        return partie_rendre(NULL, SOKOBAN_INVALIDE, erreur);
+    }
+    // dimensions bornées avant tout calcul d'indice ou allocation
+    l = lire_entier(donnees + 8, 4);
+    h = lire_entier(donnees + 12, 4);
+    if (l == 0 || h == 0 || l > SAUVEGARDE_CASES_MAX || h > SAUVEGARDE_CASES_MAX ||
+        (l + 2 * BORDURE) * (h + 2 * BORDURE) > SAUVEGARDE_CASES_MAX) {
+        return partie_rendre(NULL, SOKOBAN_INVALIDE, erreur);
+    }
+    largeur = (int)l;
+    hauteur = (int)h;
+    nb = lire_entier(donnees + 24, 8);
+    cases = (size_t)largeur * (size_t)hauteur;
+    if (lire_entier(donnees + 4, 2) != SAUVEGARDE_VERSION || nb > taille * 2 ||
+        taille != SAUVEGARDE_ENTETE + 2 * cases + (size_t)(nb + 1) / 2 ||
+        lire_entier(donnees + SAUVEGARDE_POS_SOMME, 8) != 
+        somme_sauvegarde(donnees, taille)) {
+        return partie_rendre(NULL, SOKOBAN_INVALIDE, erreur);
+    }
+
+    partie = partie_nouvelle();
+    if (partie == NULL || 
+        !plateau_depuis_cases(&partie->depart, donnees + SAUVEGARDE_ENTETE, 
+            largeur, hauteur) ||
+        !plateau_depuis_cases(&partie->plat, donnees + SAUVEGARDE_ENTETE + cases,
+            largeur, hauteur)) {
+        return partie_rendre(partie, SOKOBAN_ERREUR_MEMOIRE, erreur);
+    }
+    partie->depart.empreinte = empreinte_plateau(&partie->depart);
+    partie->plat.empreinte = partie->depart.empreinte;
+    coups = donnees + SAUVEGARDE_ENTETE + 2 * cases;
+    for (uint64_t k = 0; k < nb; k++) {
+        if (!depl_ajouter(&partie->depl, (coups[k / 2] >> (4 * (k % 2))) & 7)) {
+            return partie_rendre(partie, SOKOBAN_ERREUR_MEMOIRE, erreur);
+        }
+    }
+    partie->joueur = (int)lire_entier(donnees + 16, 4);
+    if (partie->joueur < 0 || 
+        partie->joueur >= (hauteur + 2 * BORDURE) * partie->plat.pas || 
+        !(partie->plat.cases[partie->joueur] & CASE_JOUEUR)) {
+        return partie_rendre(partie, SOKOBAN_INVALIDE, erreur);
+    }
+    res = partie_verifier(partie);
+    if (res == SOKOBAN_OK) {
+        res = partie_demarrer(partie);
+    }
+    return partie_rendre(partie, res, erreur);
+}
+
+
+/**
+* @brief Ouvre un niveau .sok ou une sauvegarde, reconnue à son entête.
+* Le fichier est projeté en mémoire et lu en place, sans copie.
+* @param fichier de type *char : le nom du fichier
+* @param erreur de type *int : reçoit SOKOBAN_OK ou le code d'erreur
+* (SOKOBAN_FICHIER si le fichier ne peut pas être lu)
+* @return la partie, NULL en cas d'erreur
+*/
+t_sokoban *sokoban_ouvrir(const char *fichier, int *erreur) {
+    struct stat infos;
+    t_sokoban *partie;
+    char *texte;
+    size_t taille;
+    int fd = open(fichier, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &infos) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return partie_rendre(NULL, SOKOBAN_FICHIER, erreur);
+    }
+    taille = (size_t)infos.st_size;
+    if (taille == 0) {
+        close(fd);
+        return sokoban_charger("", 0, erreur);
+    }
+    texte = mmap(NULL, taille, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (texte == MAP_FAILED) {
+        return partie_rendre(NULL, SOKOBAN_FICHIER, erreur);
+    }
+    if (taille >= 4 && memcmp(texte, SAUVEGARDE_MAGIE, 4) == 0) {
+        partie = sokoban_restaurer((const uint8_t *)texte, taille, erreur);
+    } else {
+        partie = sokoban_charger(texte, taille, erreur);
+    }
+    munmap(texte, taille);
+    return partie;
+}
+
+
+/**
+* @brief Copie une partie entière, historique, variantes et points de
+* contrôle compris : la copie peut être jouée sur un autre fil
+* @param partie de type *t_sokoban : la partie à copier
+* @param erreur de type *int : reçoit SOKOBAN_OK ou le code d'erreur
+* @return la copie, NULL en cas d'erreur
+*/
+t_sokoban *sokoban_cloner(t_sokoban *partie, int *erreur) {
+    t_sokoban *clone = partie_nouvelle();
+    int res = SOKOBAN_ERREUR_MEMOIRE;
+
+    if (clone != NULL && plateau_copier(&clone->plat, &partie->plat) &&
+        plateau_copier(&clone->depart, &partie->depart) &&
+        depl_copier(&clone->depl, &partie->depl) &&
+        points_copier(&clone->points, &partie->points) &&
+        arbre_copier(&clone->arbre, &partie->arbre)) {
+        clone->joueur = partie->joueur;
+        clone->joueurDepart = partie->joueurDepart;
+        res = SOKOBAN_OK;
+    }
+    return partie_rendre(clone, res, erreur);
+}
+
+
+/**
+* @brief Libère une partie et tout ce qu'elle contient
+* @param partie de type *t_sokoban : la partie (peut être NULL)
+*/
+void sokoban_liberer(t_sokoban *partie) {
+    if (partie == NULL) {
+        return;
+    }
+    plateau_liberer(&partie->plat);
+    plateau_liberer(&partie->depart);
+    depl_liberer(&partie->depl);
+    points_liberer(&partie->points);
+    arbre_liberer(&partie->arbre);
+    free(partie->vus);
+    free(partie->file);
+    free(partie->venue);
+    free(partie);
+}
+
+
+/**
+* @brief Joue un coup en tenant à jour l'historique, l'arbre des parties
+* et les points de contrôle
+* @param partie de type *t_sokoban : la partie
+* @param dir de type int : la direction (DIR_*)
+* @param modifs de type *t_modifs : reçoit les cases modifiées (peut être
+* NULL)
+* @return le coup joué (direction | COUP_POUSSEE), SOKOBAN_BLOQUE si le
+* joueur ne peut pas avancer, SOKOBAN_ERREUR_MEMOIRE si la mémoire manque
+* (la partie est alors inchangée)
+*/
+int partie_jouer(t_sokoban *partie, int dir, t_modifs *modifs) {
+    t_tab_deplacement *depl = &partie->depl;
+    int avant = partie->joueur;
+    int coup;
+
+    // la place est prise avant le coup, pour ne pas le jouer à moitié
+    if (!depl_reserver(depl, depl->nb) || 
+        !arbre_reserver(&partie->arbre, depl->nb + 1, 1)) {
+        return SOKOBAN_ERREUR_MEMOIRE;
+    }
+    coup = jouer_coup(&partie->plat, &partie->joueur, dir);
+    if (coup < 0) {
+        return SOKOBAN_BLOQUE;
+    }
+    depl_ajouter(depl, coup);
+    if (arbre_jouer(&partie->arbre, depl)) {
+        // la ligne suivie a changé après ce coup
+        points_tronquer(&partie->points, depl->nb - 1);
+    }
+    points_noter(&partie->points, &partie->plat, partie->joueur, depl->nb);
+    modifs_ajouter(modifs, avant);
+    modifs_ajouter(modifs, partie->joueur);
+    if (coup & COUP_POUSSEE) {
+        modifs_ajouter(modifs, partie->joueur + partie->plat.voisin[dir]);
+    }
+    return coup;
+}
+
+
+/**
+* @brief Annule le dernier coup joué
+* @param partie de type *t_sokoban : la partie
+* @param modifs de type *t_modifs : reçoit les cases modifiées (peut être
+* NULL)
+* @return le coup annulé, SOKOBAN_BLOQUE si aucun coup n'a été joué
+*/
+int partie_annuler(t_sokoban *partie, t_modifs *modifs) {
+    t_tab_deplacement *depl = &partie->depl;
+
+    if (depl->nb <= 0) {
+        return SOKOBAN_BLOQUE;
+    }
+    undo(&partie->plat, depl, &partie->joueur, modifs);
+    return depl_lire(depl, depl->nb);
+}
+
+
+/**
+* @brief Refait le premier coup annulé de la ligne suivie
+* @param partie de type *t_sokoban : la partie
+* @param modifs de type *t_modifs : reçoit les cases modifiées (peut être
+* NULL)
+* @return le coup refait, SOKOBAN_BLOQUE s'il n'y a rien à refaire
+*/
+int partie_refaire(t_sokoban *partie, t_modifs *modifs) {
+    t_tab_deplacement *depl = &partie->depl;
+
+    if (depl->nb >= depl->fin) {
+        return SOKOBAN_BLOQUE;
+    }
+    redo(&partie->plat, depl, &partie->joueur, modifs);
+    points_noter(&partie->points, &partie->plat, partie->joueur, depl->nb);
+    return depl_lire(depl, depl->nb - 1);
+}
+
+
+/**
+* @brief Amène le joueur sur une case par un plus court chemin sans
+* pousser de caisse. Chaque pas est joué comme un coup (historique, arbre
+* des parties, points de contrôle), donc s'annule et s'enregistre comme
+* les autres. Le parcours en largeur réutilise les tampons de la partie,
+* alloués au premier appel : une case est vue si sa marque vaut la
+* génération du parcours, si bien qu'ils ne sont jamais remis à zéro.
+* @param partie de type *t_sokoban : la partie
+* @param cible de type int : l'indice de la case visée
+* @param modifs de type *t_modifs : reçoit la case de départ et la case
+* d'arrivée (peut être NULL)
+* @return le nombre de pas, SOKOBAN_BLOQUE si la case est inaccessible,
+* SOKOBAN_ERREUR_MEMOIRE si la mémoire manque (la partie est alors
+* inchangée)
+*/
+int partie_marcher(t_sokoban *partie, int cible, t_modifs *modifs) {
+    t_plateau *plat = &partie->plat;
+    int total = (plat->hauteur + 2 * BORDURE) * plat->pas;
+    int depart = partie->joueur;
+    int debut = 0, fin = 0, pas = 0;
+
+    if (cible == depart) {
+        return 0;
+    }
+    if (cible < 0 || cible >= total || (plat->cases[cible] & CASE_BLOQUE)) {
+        return SOKOBAN_BLOQUE;
+    }
+    if (partie->vus == NULL) {
+        partie->vus = calloc((size_t)total, sizeof(uint32_t));
+        partie->file = malloc((size_t)total * sizeof(int32_t));
+        partie->venue = malloc((size_t)total);
+        if (partie->vus == NULL || partie->file == NULL || 
+            partie->venue == NULL) {
+            free(partie->vus);
+            free(partie->file);
+            free(partie->venue);
+            partie->vus = NULL;
+            partie->file = NULL;
+            partie->venue = NULL;
+            return SOKOBAN_ERREUR_MEMOIRE;
+        }
+        partie->generation = 0;
+    }
+    if (++partie->generation == 0) {
+        memset(partie->vus, 0, (size_t)total * sizeof(uint32_t));
+        partie->generation = 1;
+    }
+
+    partie->vus[depart] = partie->generation;
+    partie->file[fin++] = depart;
+    while (debut < fin && partie->vus[cible] != partie->generation) {
+        int c = partie->file[debut++];
+        for (int d = 0; d < NB_DIRECTIONS; d++) {
+            int v = c + plat->voisin[d];
+            if (partie->vus[v] != partie->generation && 
+                !(plat->cases[v] & CASE_BLOQUE)) {
+                partie->vus[v] = partie->generation;
+                partie->venue[v] = (uint8_t)d;
+                partie->file[fin++] = v;
+            }
+        }
+    }
+    if (partie->vus[cible] != partie->generation) {
+        return SOKOBAN_BLOQUE;
+    }
+
+    // le chemin, de la cible vers le joueur, remplace la file
+    for (int c = cible; c != depart; c -= plat->voisin[partie->venue[c]]) {
+        partie->file[pas++] = partie->venue[c];
+    }
+    for (long k = partie->depl.nb; k < partie->depl.nb + pas; k++) {
+        if (!depl_reserver(&partie->depl, k)) {
+            return SOKOBAN_ERREUR_MEMOIRE;
+        }
+    }
+    if (!arbre_reserver(&partie->arbre, partie->depl.nb + pas, pas)) {
+        return SOKOBAN_ERREUR_MEMOIRE;
+    }
+    for (int k = pas - 1; k >= 0; k--) {
+        partie_jouer(partie, partie->file[k], NULL);
+    }
+    modifs_ajouter(modifs, depart);
+    modifs_ajouter(modifs, partie->joueur);
+    return pas;
+}
+
+
+/**
+* @brief Joue un coup
+* @param partie de type *t_sokoban : la partie
+* @param direction de type int : SOKOBAN_HAUT, SOKOBAN_BAS, SOKOBAN_GAUCHE
+* ou SOKOBAN_DROITE
+* @return le coup joué (direction | SOKOBAN_POUSSEE), SOKOBAN_BLOQUE,
+* SOKOBAN_INVALIDE ou SOKOBAN_ERREUR_MEMOIRE (la partie est alors
+* inchangée)
+*/
+int sokoban_jouer(t_sokoban *partie, int direction) {
+    if (direction < 0 || direction >= NB_DIRECTIONS) {
+        return SOKOBAN_INVALIDE;
+    }
+    return partie_jouer(partie, direction, NULL);
+}
+
+
+/**
+* @brief Amène le joueur sur la case (i, j) sans pousser de caisse, par
+* un plus court chemin (voir partie_marcher()) ; chaque pas est un coup
+* @param partie de type *t_sokoban : la partie
+* @param i de type int : la ligne de la case
+* @param j de type int : la colonne de la case
+* @return le nombre de pas, SOKOBAN_BLOQUE si la case est inaccessible,
+* SOKOBAN_INVALIDE si elle est hors du plateau ou SOKOBAN_ERREUR_MEMOIRE
+* (la partie est alors inchangée)
+*/
+int sokoban_marcher(t_sokoban *partie, int i, int j) {
+    if (i < 0 || i >= partie->plat.hauteur || j < 0 || 
+        j >= partie->plat.largeur) {
+        return SOKOBAN_INVALIDE;
+    }
+    return partie_marcher(partie, plateau_indice(&partie->plat, i, j), NULL);
+}
+
+
+/**
+* @brief Annule le dernier coup joué ; il peut être refait
+* @param partie de type *t_sokoban : la partie
+* @return le coup annulé, SOKOBAN_BLOQUE si aucun coup n'a été joué
+*/
+int sokoban_annuler(t_sokoban *partie) {
+    return partie_annuler(partie, NULL);
+}
+
+
+/**
+* @brief Refait le premier coup annulé
+* @param partie de type *t_sokoban : la partie
+* @return le coup refait, SOKOBAN_BLOQUE s'il n'y a rien à refaire
+*/
+int sokoban_refaire(t_sokoban *partie) {
+    return partie_refaire(partie, NULL);
+}
+
+
+/**
+* @brief Amène la partie au coup n de la ligne suivie (voir aller_au_coup())
+* @param partie de type *t_sokoban : la partie
+* @param coup de type long : le coup visé, ramené entre 0 et
+* sokoban_nb_enregistres()
+*/
+void sokoban_aller(t_sokoban *partie, long coup) {
+    aller_au_coup(&partie->plat, &partie->joueur, &partie->depl, 
+        &partie->points, coup);
+}
+
+
+/**
+* @brief Revient au début du niveau ; les coups joués peuvent être refaits
+* @param partie de type *t_sokoban : la partie
+*/
+void sokoban_recommencer(t_sokoban *partie) {
+    sokoban_aller(partie, 0);
+}
+
+
+/**
+* @brief Indique si toutes les cibles sont couvertes
+* @param partie de type *t_sokoban : la partie
+* @return true si la partie est gagnée
+*/
+bool sokoban_gagne(t_sokoban *partie) {
+    return gagne(&partie->plat);
+}
+
+
+/**
+* @brief Indique si la partie ne peut plus être gagnée (voir en_impasse())
+* @param partie de type *t_sokoban : la partie
+* @return true si la partie est perdue
+*/
+bool sokoban_impasse(t_sokoban *partie) {
+    return en_impasse(&partie->plat);
+}
+
+
+/**
+* @brief Donne le nombre de coups joués
+* @param partie de type *t_sokoban : la partie
+* @return le nombre de coups
+*/
+long sokoban_nb_coups(t_sokoban *partie) {
+    return partie->depl.nb;
+}
+
+
+/**
+* @brief Donne le nombre de coups de la ligne suivie, coups à refaire
+* compris
+* @param partie de type *t_sokoban : la partie
+* @return le nombre de coups
+*/
+long sokoban_nb_enregistres(t_sokoban *partie) {
+    return partie->depl.fin;
+}
+
+
+/**
+* @brief Lit un coup de la ligne suivie
+* @param partie de type *t_sokoban : la partie
+* @param k de type long : le numéro du coup, à partir de 0
+* @return le coup (direction | SOKOBAN_POUSSEE), SOKOBAN_INVALIDE si k
+* est hors de la ligne
+*/
+int sokoban_coup(t_sokoban *partie, long k) {
+    if (k < 0 || k >= partie->depl.fin) {
+        return SOKOBAN_INVALIDE;
+    }
+    return depl_lire(&partie->depl, k);
+}
+
+
+/**
+* @brief Donne les variantes jouées depuis la position actuelle
+* (voir arbre_branches())
+* @param partie de type *t_sokoban : la partie
+* @param coups de type int[4] : reçoit le premier coup de chaque variante
+* @param longueurs de type long[4] : reçoit le nombre de coups de chacune
+* @return le nombre de variantes, la première étant la ligne suivie
+*/
+int sokoban_variantes(t_sokoban *partie, int coups[4], long longueurs[4]) {
+    return arbre_branches(&partie->arbre, &partie->depl, coups, longueurs);
+}
+
+
+/**
+* @brief Fait d'une variante la ligne suivie, que sokoban_refaire()
+* rejouera ; le plateau ne change pas
+* @param partie de type *t_sokoban : la partie
+* @param k de type int : le numéro de la variante
+* @return SOKOBAN_OK, ou SOKOBAN_ERREUR_MEMOIRE si les coups à refaire
+* ont dû être écourtés
+*/
+int sokoban_choisir_variante(t_sokoban *partie, int k) {
+    bool ok = arbre_choisir(&partie->arbre, &partie->depl, k);
+
+    points_tronquer(&partie->points, partie->depl.nb);
+    return ok ? SOKOBAN_OK : SOKOBAN_ERREUR_MEMOIRE;
+}
+
+
+/**
+* @brief Donne le nombre de colonnes du niveau
+* @param partie de type *t_sokoban : la partie
+* @return la largeur
+*/
+int sokoban_largeur(t_sokoban *partie) {
+    return partie->plat.largeur;
+}
+
+
+/**
+* @brief Donne le nombre de lignes du niveau
+* @param partie de type *t_sokoban : la partie
+* @return la hauteur
+*/
+int sokoban_hauteur(t_sokoban *partie) {
+    return partie->plat.hauteur;
+}
+
+
+/**
+* @brief Donne le caractère .sok d'une case du plateau
+* @param partie de type *t_sokoban : la partie
+* @param i de type int : la ligne
+* @param j de type int : la colonne
+* @return le caractère, MUR hors du niveau
+*/
+char sokoban_case(t_sokoban *partie, int i, int j) {
+    t_plateau *plat = &partie->plat;
+
+    if (i < 0 || j < 0 || i >= plat->hauteur || j >= plat->largeur) {
+        return MUR;
+    }
+    return case_vers_car(plat->cases[plateau_indice(plat, i, j)]);
+}
+
+
+/**
+* @brief Donne la case du joueur
+* @param partie de type *t_sokoban : la partie
+* @param i de type *int : reçoit la ligne
+* @param j de type *int : reçoit la colonne
+*/
+void sokoban_joueur(t_sokoban *partie, int *i, int *j) {
+    *i = partie->joueur / partie->plat.pas - BORDURE;
+    *j = partie->joueur % partie->plat.pas - BORDURE;
+}
+
+
+/**
+* @brief Enregistre une partie complète dans un tampon : entête de
+* SAUVEGARDE_ENTETE octets ("SOKS", version, largeur, hauteur, case du
+* joueur, nombre de coups, somme de contrôle, en petit-boutiste), puis
+* les cases du niveau de départ et celles du plateau actuel (un octet
+* par case, sans la bordure), puis l'historique à deux coups par octet
+* @param partie de type *t_sokoban : la partie
+* @param tampon de type *uint8_t : reçoit la sauvegarde (peut être NULL)
+* @param taille de type size_t : la taille du tampon
+* @return la taille de la sauvegarde ; rien n'est écrit si le tampon est
+* trop petit
+*/
+size_t sokoban_serialiser(t_sokoban *partie, uint8_t *tampon, size_t taille) {
+    t_plateau *depart = &partie->depart;
+    t_plateau *plat = &partie->plat;
+    t_tab_deplacement *depl = &partie->depl;
+    size_t cases = (size_t)plat->largeur * (size_t)plat->hauteur;
+    size_t total = SAUVEGARDE_ENTETE + 2 * cases + (size_t)(depl->nb + 1) / 2;
+    uint8_t *p;
+
+    if (tampon == NULL || taille < total) {
+        return total;
+    }
+    memset(tampon, 0, total);
+    memcpy(tampon, SAUVEGARDE_MAGIE, 4);
+    ecrire_entier(tampon + 4, SAUVEGARDE_VERSION, 2);
+    ecrire_entier(tampon + 8, (uint64_t)plat->largeur, 4);
+    ecrire_entier(tampon + 12, (uint64_t)plat->hauteur, 4);
+    ecrire_entier(tampon + 16, (uint64_t)partie->joueur, 4);
+    ecrire_entier(tampon + 24, (uint64_t)depl->nb, 8);
+    p = tampon + SAUVEGARDE_ENTETE;
+    for (int i = 0; i < plat->hauteur; i++) {
+        for (int j = 0; j < plat->largeur; j++) {
+            p[0] = depart->cases[plateau_indice(depart, i, j)] & (uint8_t)~CASE_MORTE;
+            p[cases] = plat->cases[plateau_indice(plat, i, j)] & (uint8_t)~CASE_MORTE;
+            p++;
+        }
+    }
+    p += cases;
+    for (long k = 0; k < depl->nb; k++) {
+        p[k / 2] |= (uint8_t)(depl_lire(depl, k) << (4 * (k % 2)));
+    }
+    ecrire_entier(tampon + SAUVEGARDE_POS_SOMME, somme_sauvegarde(tampon, total), 8);
+    return total;
+}
+
+
+/**
+* @brief Donne l'empreinte de la position actuelle (voir
+* empreinte_plateau())
+* @param partie de type *t_sokoban : la partie
+* @return l'empreinte sur 64 bits
+*/
+uint64_t sokoban_empreinte(t_sokoban *partie) {
+    return empreinte_plateau(&partie->plat);
+}
+
+
+// Formes canoniques
+
+
+/**
+* @brief Fait tourner un entier de 64 bits vers la gauche
+* @param x de type uint64_t : la valeur
+* @param n de type int : le nombre de bits, de 1 à 63
+* @return la valeur tournée
+*/
+static uint64_t rotation64(uint64_t x, int n) {
+    return (x << n) | (x >> (64 - n));
+}
+
+
+/**
+* @brief Mélange final de MurmurHash3
+* @param k de type uint64_t : la valeur
+* @return la valeur mélangée
+*/
+static uint64_t melange64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDull;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ull;
+    return k ^ (k >> 33);
+}
+
+
+/**
+* @brief Calcule une empreinte sur 128 bits (MurmurHash3 x64_128, graine
+* nulle) : 16 octets par tour, sans allocation
+* @param octets de type *uint8_t : les données
+* @param n de type size_t : leur taille
+* @param h de type uint64_t[2] : reçoit l'empreinte
+*/
+void empreinte_128(const uint8_t *octets, size_t n, uint64_t h[2]) {
+    const uint64_t c1 = 0x87C37B91114253D5ull, c2 = 0x4CF5AD432745937Full;
+    uint64_t h1 = 0, h2 = 0, k1, k2;
+    size_t fin = n - n % 16;
+
+    for (size_t k = 0; k < fin; k += 16) {
+        k1 = lire_entier(octets + k, 8);
+        k2 = lire_entier(octets + k + 8, 8);
+        h1 ^= rotation64(k1 * c1, 31) * c2;
+        h1 = (rotation64(h1, 27) + h2) * 5 + 0x52DCE729;
+        h2 ^= rotation64(k2 * c2, 33) * c1;
+        h2 = (rotation64(h2, 31) + h1) * 5 + 0x38495AB5;
+    }
+    k1 = 0;
+    k2 = 0;
+    for (size_t k = fin; k < n; k++) {
+        if (k - fin < 8) {
+            k1 |= (uint64_t)octets[k] << (8 * (k - fin));
+        } else {
+            k2 |= (uint64_t)octets[k] << (8 * (k - fin - 8));
+        }
+    }
+    if (n - fin > 8) {
+        h2 ^= rotation64(k2 * c2, 33) * c1;
+    }
+    if (n > fin) {
+        h1 ^= rotation64(k1 * c1, 31) * c2;
+    }
+    h1 ^= (uint64_t)n;
+    h2 ^= (uint64_t)n;
+    h1 += h2;
+    h2 += h1;
+    h1 = melange64(h1);
+    h2 = melange64(h2);
+    h1 += h2;
+    h2 += h1;
+    h[0] = h1;
+    h[1] = h2;
+}
+
+
+/**
+* @brief Marque les cases atteintes depuis une case sans traverser les
+* cases bloquantes (parcours en largeur)
+* @param plat de type *t_plateau : le plateau
+* @param depart de type int : la case de départ
+* @param bloque de type uint8_t : les bits CASE_* qui arrêtent le parcours
+* @param marques de type uint8_t[] : reçoit bit aux cases atteintes
+* @param bit de type uint8_t : la marque
+* @param file de type int[] : tampon d'une case par case du plateau
+*/
+static void marquer_zone(t_plateau *plat, int depart, uint8_t bloque,
+    uint8_t marques[], uint8_t bit, int file[]) {
+    int debut = 0, fin = 0;
+
+    marques[depart] |= bit;
+    file[fin++] = depart;
+    while (debut < fin) {
+        int c = file[debut++];
+        for (int d = 0; d < NB_DIRECTIONS; d++) {
+            int v = c + plat->voisin[d];
+            if (!(marques[v] & bit) && !(plat->cases[v] & bloque)) {
+                marques[v] |= bit;
+                file[fin++] = v;
+            }
+        }
+    }
+}
+
+
+/**
+* @brief Calcule la clé canonique d'un niveau, la même pour toutes ses
+* copies tournées, retournées, décalées ou autrement encadrées. Les cases
+* que le joueur ne peut pas atteindre même sans caisse deviennent des
+* murs, le plateau est réduit à la boîte qui contient les autres, la case
+* du joueur est remplacée par toute sa zone (les cases atteintes sans
+* pousser) ; la forme retenue est la plus petite, octet par octet, des
+* 8 rotations et symétries, et la clé est son empreinte_128().
+* @param plat de type *t_plateau : le niveau, tel que chargé
+* @param joueur de type int : la case du joueur, -1 s'il n'y en a pas
+* @param cle de type uint64_t[2] : reçoit la clé
+* @return false si la mémoire manque
+*/
+bool cle_canonique(t_plateau *plat, int joueur, uint64_t cle[2]) {
+    int total = (plat->hauteur + 2 * BORDURE) * plat->pas;
+    int imin = plat->hauteur, imax = -1, jmin = plat->largeur, jmax = -1;
+    int hauteur, largeur;
+    size_t taille;
+    uint8_t *marques, *code, *meilleure, *forme;
+    int *file;
+
+    marques = calloc((size_t)total, 1);
+    file = malloc((size_t)total * sizeof(int));
+    code = malloc((size_t)total);
+    meilleure = malloc(2 * ((size_t)total + 8));
+    if (marques == NULL || file == NULL || code == NULL || meilleure == NULL) {
+        free(marques);
+        free(file);
+        free(code);
+        free(meilleure);
+        return false;
+    }
+    forme = meilleure + total + 8;
+
+    // intérieur (1) et zone du joueur (2)
+    if (joueur >= 0) {
+        marquer_zone(plat, joueur, CASE_MUR, marques, 1, file);
+        marquer_zone(plat, joueur, CASE_BLOQUE, marques, 2, file);
+    } else {
+        memset(marques, 1, (size_t)total);
+    }
+    for (int i = 0; i < plat->hauteur; i++) {
+        for (int j = 0; j < plat->largeur; j++) {
+            int k = plateau_indice(plat, i, j);
+            uint8_t c = plat->cases[k] & (CASE_MUR | CASE_CAISSE | CASE_CIBLE);
+            if (!(marques[k] & 1) && !(c & (CASE_CAISSE | CASE_CIBLE))) {
+                c = CASE_MUR;
+            }
+            if (marques[k] & 2) {
+                c |= CASE_JOUEUR;
+            }
+            code[k] = c;
+            if (c != CASE_MUR) {
+                imin = (i < imin) ? i : imin;
+                imax = (i > imax) ? i : imax;
+                jmin = (j < jmin) ? j : jmin;
+                jmax = (j > jmax) ? j : jmax;
+            }
+        }
+    }
+    hauteur = (imax >= imin) ? imax - imin + 1 : 0;
+    largeur = (jmax >= jmin) ? jmax - jmin + 1 : 0;
+    taille = 8 + (size_t)hauteur * (size_t)largeur;
+
+    // bit 0 : retournement vertical, bit 1 : horizontal, bit 2 : transposée
+    for (int s = 0; s < 8; s++) {
+        int h = (s & 4) ? largeur : hauteur;
+        int l = (s & 4) ? hauteur : largeur;
+        uint8_t *sortie = (s == 0) ? meilleure : forme;
+        size_t n = 8;
+
+        ecrire_entier(sortie, (uint64_t)l, 4);
+        ecrire_entier(sortie + 4, (uint64_t)h, 4);
+        for (int a = 0; a < h; a++) {
+            for (int b = 0; b < l; b++) {
+                int i = (s & 4) ? b : a;
+                int j = (s & 4) ? a : b;
+                if (s & 1) {
+                    i = hauteur - 1 - i;
+                }
+                if (s & 2) {
+                    j = largeur - 1 - j;
+                }
+                sortie[n++] = code[plateau_indice(plat, imin + i, jmin + j)];
+            }
+        }
+        if (s > 0 && memcmp(forme, meilleure, taille) < 0) {
+            memcpy(meilleure, forme, taille);
+        }
+    }
+    empreinte_128(meilleure, taille, cle);
+    free(marques);
+    free(file);
+    free(code);
+    free(meilleure);
+    return true;
+}
+
+
+/**
+* @brief Donne la clé canonique du niveau de la partie (voir
+* cle_canonique()) : deux niveaux qui ne diffèrent que par une rotation,
+* une symétrie, un décalage, l'encadrement ou la case du joueur dans sa
+* zone ont la même clé
+* @param partie de type *t_sokoban : la partie
+* @param cle de type uint64_t[2] : reçoit la clé sur 128 bits
+* @return SOKOBAN_OK ou SOKOBAN_ERREUR_MEMOIRE
+*/
+int sokoban_cle(t_sokoban *partie, uint64_t cle[2]) {
+    if (!cle_canonique(&partie->depart, partie->joueurDepart, cle)) {
+        return SOKOBAN_ERREUR_MEMOIRE;
+    }
+    return SOKOBAN_OK;
+}
+
+
+// Index des niveaux
+
+
+/**
+* @brief Projette un index de la capacité demandée : le fichier est
+* agrandi et projeté en partage, ou une zone anonyme est réservée pour un
+* index en mémoire ; les emplacements ajoutés sont nuls
+* @param fd de type int : le fichier, -1 pour un index en mémoire
+* @param capacite de type uint64_t : le nombre d'emplacements
+* @return la projection, NULL en cas d'échec
+*/
+static uint8_t *index_projeter(int fd, uint64_t capacite) {
+    size_t octets = INDEX_ENTETE + (size_t)capacite * INDEX_ENTREE;
+    uint8_t *carte;
+
+    if (fd >= 0) {
+        if (ftruncate(fd, (off_t)octets) != 0) {
+            return NULL;
+        }
+        carte = mmap(NULL, octets, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    } else {
+        carte = mmap(NULL, octets, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    return (carte == MAP_FAILED) ? NULL : carte;
+}
+
+
+/**
+* @brief Cherche une clé par sondage linéaire
+* @param carte de type *uint8_t : la projection de l'index
+* @param capacite de type uint64_t : le nombre d'emplacements (puissance de 2)
+* @param cle de type uint64_t[2] : la clé, non nulle
+* @param place de type *uint64_t : reçoit l'emplacement de la clé, ou
+* l'emplacement libre où l'ajouter
+* @return true si la clé est dans l'index
+*/
+static bool index_chercher(const uint8_t *carte, uint64_t capacite,
+    const uint64_t cle[2], uint64_t *place) {
+    uint64_t k = cle[0] & (capacite - 1);
+
+    for (;;) {
+        const uint8_t *e = carte + INDEX_ENTETE + k * INDEX_ENTREE;
+        uint64_t a = lire_entier(e, 8), b = lire_entier(e + 8, 8);
+        if (a == cle[0] && b == cle[1]) {
+            *place = k;
+            return true;
+        }
+        if (a == 0 && b == 0) {
+            *place = k;
+            return false;
+        }
+        k = (k + 1) & (capacite - 1);
+    }
+}
+
+
+/**
+* @brief Écrit l'en-tête de l'index : "SOKX", version, capacité et
+* nombre de clés
+* @param carte de type *uint8_t : la projection de l'index
+* @param capacite de type uint64_t : le nombre d'emplacements
+* @param nombre de type uint64_t : le nombre de clés
+*/
+static void index_entete(uint8_t *carte, uint64_t capacite, uint64_t nombre) {
+    memcpy(carte, INDEX_MAGIE, 4);
+    ecrire_entier(carte + 4, INDEX_VERSION, 4);
+    ecrire_entier(carte + 8, capacite, 8);
+    ecrire_entier(carte + 16, nombre, 8);
+}
+
+
+/**
+* @brief Double la capacité de l'index en replaçant toutes les clés dans
+* une nouvelle table. Pour un index en fichier, la table est construite
+* dans fichier.tmp puis renommée sur le fichier : un arrêt en cours de
+* route laisse l'ancien index intact.
+* @param index de type *t_sokoban_index : l'index, inchangé en cas d'échec
+* @return false si la mémoire ou le disque manque
+*/
+static bool index_agrandir(t_sokoban_index *index) {
+    uint64_t capacite = 2 * index->capacite;
+    size_t octets = INDEX_ENTETE + (size_t)capacite * INDEX_ENTREE;
+    char *temporaire = NULL;
+    uint8_t *carte = NULL;
+    int fd = -1;
+    bool ok;
+
+    if (index->fichier != NULL) {
+        size_t n = strlen(index->fichier);
+        temporaire = malloc(n + 5);
+        if (temporaire == NULL) {
+            return false;
+        }
+        memcpy(temporaire, index->fichier, n);
+        memcpy(temporaire + n, ".tmp", 5);
+        fd = open(temporaire, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+    ok = (index->fichier == NULL || fd >= 0) &&
+        (carte = index_projeter(fd, capacite)) != NULL;
+    if (ok) {
+        for (uint64_t k = 0; k < index->capacite; k++) {
+            const uint8_t *e = index->carte + INDEX_ENTETE + k * INDEX_ENTREE;
+            uint64_t cle[2] = { lire_entier(e, 8), lire_entier(e + 8, 8) };
+            uint64_t place;
+            if (cle[0] != 0 || cle[1] != 0) {
+                index_chercher(carte, capacite, cle, &place);
+                memcpy(carte + INDEX_ENTETE + place * INDEX_ENTREE, e,
+                    INDEX_ENTREE);
+            }
+        }
+        index_entete(carte, capacite, index->nombre);
+    }
+    // la nouvelle table est sur le disque avant de remplacer l'ancienne
+    if (ok && fd >= 0) {
+        ok = msync(carte, octets, MS_SYNC) == 0 &&
+            rename(temporaire, index->fichier) == 0;
+    }
+    if (!ok) {
+        if (carte != NULL) {
+            munmap(carte, octets);
+        }
+        if (fd >= 0) {
+            close(fd);
+            unlink(temporaire);
+        }
+        free(temporaire);
+        return false;
+    }
+    munmap(index->carte, index->octets);
+    if (fd >= 0) {
+        close(index->fd);
+        index->fd = fd;
+    }
+    index->carte = carte;
+    index->octets = octets;
+    index->capacite = capacite;
+    free(temporaire);
+    return true;
+}
+
+
+/**
+* @brief Ouvre un index de clés de niveaux (voir sokoban_cle()), ou le
+* crée s'il n'existe pas ou est vide. Le fichier est projeté en mémoire :
+* une recherche lit un ou deux emplacements, sans lecture du disque une
+* fois les pages en cache. Un index ne doit être ouvert que par un
+* programme à la fois.
+* @param fichier de type *char : le fichier, NULL pour un index en mémoire
+* @param erreur de type *int : reçoit SOKOBAN_OK ou le code d'erreur
+* (SOKOBAN_INVALIDE si le fichier n'est pas un index ; ignoré si NULL)
+* @return l'index, NULL en cas d'erreur
+*/
+t_sokoban_index *sokoban_index_ouvrir(const char *fichier, int *erreur) {
+    t_sokoban_index *index = malloc(sizeof(t_sokoban_index));
+    struct stat infos;
+    int res = SOKOBAN_OK;
+
+    if (index == NULL) {
+        if (erreur != NULL) {
+            *erreur = SOKOBAN_ERREUR_MEMOIRE;
+        }
+        return NULL;
+    }
+    index->carte = NULL;
+    index->capacite = INDEX_CAPACITE_MIN;
+    index->nombre = 0;
+    index->fd = -1;
+    index->fichier = NULL;
+    if (fichier != NULL) {
+        size_t n = strlen(fichier) + 1;
+        index->fichier = malloc(n);
+        if (index->fichier == NULL) {
+            res = SOKOBAN_ERREUR_MEMOIRE;
+        } else {
+            memcpy(index->fichier, fichier, n);
+            index->fd = open(fichier, O_RDWR | O_CREAT, 0644);
+            if (index->fd < 0 || fstat(index->fd, &infos) != 0) {
+                res = SOKOBAN_FICHIER;
+            }
+        }
+    }
+    if (res == SOKOBAN_OK && index->fd >= 0 && infos.st_size > 0) {
+        size_t taille = (size_t)infos.st_size;
+        uint8_t *carte = mmap(NULL, taille, PROT_READ | PROT_WRITE, 
+            MAP_SHARED, index->fd, 0);
+        if (carte == MAP_FAILED) {
+            res = SOKOBAN_FICHIER;
+        } else {
+            index->carte = carte;
+            index->octets = taille;
+            index->capacite = (taille >= INDEX_ENTETE) ? 
+                lire_entier(carte + 8, 8) : 0;
+            index->nombre = (taille >= INDEX_ENTETE) ? 
+                lire_entier(carte + 16, 8) : 0;
+            if (taille < INDEX_ENTETE || memcmp(carte, INDEX_MAGIE, 4) != 0 ||
+                lire_entier(carte + 4, 4) != INDEX_VERSION ||
+                index->capacite == 0 ||
+                (index->capacite & (index->capacite - 1)) != 0 ||
+                index->capacite > (taille - INDEX_ENTETE) / INDEX_ENTREE ||
+                taille < INDEX_ENTETE + index->capacite * INDEX_ENTREE ||
+                index->nombre >= index->capacite) {
+                munmap(carte, taille);
+                index->carte = NULL;
+                res = SOKOBAN_INVALIDE;
+            }
+        }
+    } else if (res == SOKOBAN_OK) {
+        index->carte = index_projeter(index->fd, index->capacite);
+        index->octets = INDEX_ENTETE + (size_t)index->capacite * INDEX_ENTREE;
+        if (index->carte == NULL) {
+            res = (index->fd >= 0) ? SOKOBAN_FICHIER : SOKOBAN_ERREUR_MEMOIRE;
+        } else {
+            index_entete(index->carte, index->capacite, index->nombre);
+        }
+    }
+    if (res != SOKOBAN_OK) {
+        if (index->fd >= 0) {
+            close(index->fd);
+        }
+        free(index->fichier);
+        free(index);
+        index = NULL;
+    }
+    if (erreur != NULL) {
+        *erreur = res;
+    }
+    return index;
+}
+
+
+/**
+* @brief Ajoute une clé à l'index si elle n'y est pas déjà ; la clé nulle
+* est confondue avec (1, 0)
+* @param index de type *t_sokoban_index : l'index
+* @param cle de type uint64_t[2] : la clé
+* @return 1 si la clé est nouvelle, 0 si elle était déjà dans l'index,
+* SOKOBAN_ERREUR_MEMOIRE si l'index ne peut pas grandir
+*/
+int sokoban_index_ajouter(t_sokoban_index *index, const uint64_t cle[2]) {
+    uint64_t c[2] = { cle[0], cle[1] };
+    uint64_t place;
+
+    if (c[0] == 0 && c[1] == 0) {
+        c[0] = 1;
+    }
+    if (index_chercher(index->carte, index->capacite, c, &place)) {
+        return 0;
+    }
+    // au plus 3/4 des emplacements occupés
+    if (4 * (index->nombre + 1) > 3 * index->capacite) {
+        if (!index_agrandir(index)) {
+            return SOKOBAN_ERREUR_MEMOIRE;
+        }
+        index_chercher(index->carte, index->capacite, c, &place);
+    }
+    ecrire_entier(index->carte + INDEX_ENTETE + place * INDEX_ENTREE, c[0], 8);
+    ecrire_entier(index->carte + INDEX_ENTETE + place * INDEX_ENTREE + 8, 
+        c[1], 8);
+    index->nombre++;
+    ecrire_entier(index->carte + 16, index->nombre, 8);
+    return 1;
+}
+
+
+/**
+* @brief Dit si une clé est dans l'index
+* @param index de type *t_sokoban_index : l'index
+* @param cle de type uint64_t[2] : la clé
+* @return true si la clé a déjà été ajoutée
+*/
+bool sokoban_index_contient(t_sokoban_index *index, const uint64_t cle[2]) {
+    uint64_t c[2] = { cle[0], cle[1] };
+    uint64_t place;
+
+    if (c[0] == 0 && c[1] == 0) {
+        c[0] = 1;
+    }
+    return index_chercher(index->carte, index->capacite, c, &place);
+}
+
+
+/**
+* @brief Donne le nombre de clés de l'index
+* @param index de type *t_sokoban_index : l'index
+* @return le nombre de clés
+*/
+long sokoban_index_nombre(t_sokoban_index *index) {
+    return (long)index->nombre;
+}
+
+
+/**
+* @brief Ferme un index : un index en fichier est enregistré, un index en
+* mémoire est perdu
+* @param index de type *t_sokoban_index : l'index (NULL accepté)
+*/
+void sokoban_index_fermer(t_sokoban_index *index) {
+    if (index == NULL) {
+        return;
+    }
+    munmap(index->carte, index->octets);
+    if (index->fd >= 0) {
+        close(index->fd);
+    }
+    free(index->fichier);
+    free(index);
+}
@@ -0,0 +1,84 @@
+/**
+* @file libsokoban.h
+* @brief Sokoban : interface du moteur de jeu (libsokoban.a)
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* Une partie est un contexte opaque (t_sokoban) : niveau de départ,
+* plateau, historique, arbre des variantes et points de contrôle. Le
+* moteur n'écrit rien à l'écran et n'a pas de variable globale ; chaque
+* partie ne doit être utilisée que par un fil d'exécution à la fois, mais
+* des parties différentes (par exemple des clones) peuvent être jouées en
+* parallèle, et plusieurs fils peuvent cloner en même temps une partie
+* que personne ne joue.
+*
+*/
+
+#ifndef LIBSOKOBAN_H
+#define LIBSOKOBAN_H
+
+/* Fichiers inclus */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Définition de constante*/
+#define SOKOBAN_OK 0
+#define SOKOBAN_BLOQUE -1
+#define SOKOBAN_ERREUR_MEMOIRE -2
+#define SOKOBAN_INVALIDE -3
+#define SOKOBAN_FICHIER -4
+#define SOKOBAN_HAUT 0
+#define SOKOBAN_BAS 1
+#define SOKOBAN_GAUCHE 2
+#define SOKOBAN_DROITE 3
+#define SOKOBAN_POUSSEE 4
+
+/* Définition de type*/
+/**
+* @typedef t_sokoban
+* @brief Une partie en cours, manipulée par les fonctions sokoban_*
+*/
+typedef struct s_sokoban t_sokoban;
+
+/**
+* @typedef t_sokoban_index
+* @brief Index des clés de niveaux déjà vus, en fichier ou en mémoire
+*/
+typedef struct s_sokoban_index t_sokoban_index;
+
+/* Définition de fonction*/
+t_sokoban *sokoban_charger(const char *texte, size_t taille, int *erreur);
+t_sokoban *sokoban_restaurer(const uint8_t *donnees, size_t taille,
+    int *erreur);
+t_sokoban *sokoban_ouvrir(const char *fichier, int *erreur);
+t_sokoban *sokoban_cloner(t_sokoban *partie, int *erreur);
+void sokoban_liberer(t_sokoban *partie);
+int sokoban_jouer(t_sokoban *partie, int direction);
+int sokoban_annuler(t_sokoban *partie);
+int sokoban_refaire(t_sokoban *partie);
+int sokoban_marcher(t_sokoban *partie, int i, int j);
+void sokoban_aller(t_sokoban *partie, long coup);
+void sokoban_recommencer(t_sokoban *partie);
+bool sokoban_gagne(t_sokoban *partie);
+bool sokoban_impasse(t_sokoban *partie);
+long sokoban_nb_coups(t_sokoban *partie);
+long sokoban_nb_enregistres(t_sokoban *partie);
+int sokoban_coup(t_sokoban *partie, long k);
+int sokoban_variantes(t_sokoban *partie, int coups[4], long longueurs[4]);
+int sokoban_choisir_variante(t_sokoban *partie, int k);
+int sokoban_largeur(t_sokoban *partie);
+int sokoban_hauteur(t_sokoban *partie);
+char sokoban_case(t_sokoban *partie, int i, int j);
+void sokoban_joueur(t_sokoban *partie, int *i, int *j);
+size_t sokoban_serialiser(t_sokoban *partie, uint8_t *tampon, size_t taille);
+uint64_t sokoban_empreinte(t_sokoban *partie);
+int sokoban_cle(t_sokoban *partie, uint64_t cle[2]);
+t_sokoban_index *sokoban_index_ouvrir(const char *fichier, int *erreur);
+int sokoban_index_ajouter(t_sokoban_index *index, const uint64_t cle[2]);
+bool sokoban_index_contient(t_sokoban_index *index, const uint64_t cle[2]);
+long sokoban_index_nombre(t_sokoban_index *index);
+void sokoban_index_fermer(t_sokoban_index *index);
+
+#endif
@@ -0,0 +1,606 @@
+/**
+* @file serveur_sokoban.c
+* @brief Serveur de parties Sokoban sur une socket Unix locale
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* Un seul processus, une seule boucle epoll : chaque connexion est une
+* session avec sa propre partie (clone du niveau, voir libsokoban.h), son
+* historique et son zoom. Les sockets sont non bloquantes et les réponses
+* qui ne partent pas tout de suite attendent EPOLLOUT. Un client qui ne
+* lit pas ses réponses n'est plus lu dès qu'il en a SORTIE_MAX en
+* attente, ce qui borne la mémoire de chaque session ; une session dont
+* la sortie ne peut pas grandir est fermée.
+*
+* Protocole : une commande par ligne, une réponse par commande.
+*   z, q, s, d   déplacement         -> "ok N", "gagne N" ou "bloque N"
+*   u, y         annuler, refaire    -> idem
+*   r            recommencer         -> idem
+*   +, -         zoom                -> "zoom Z"
+*   e            état                -> "etat N Z G L" puis les L lignes du
+*                                       plateau, agrandies par le zoom
+*   n K          niveau K (à partir de 1) -> "ok 0"
+* N est le nombre de coups joués, G vaut 1 si la partie est gagnée. Une
+* commande inconnue reçoit "erreur <raison>".
+*
+*/
+
+/* Fichiers inclus */
+#define _GNU_SOURCE     // accept4()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include "libsokoban.h"
+
+/* Définition de constante*/
+#define SESSION_ENTREE 256
+#define SORTIE_CAPACITE_INIT 256
+#define SORTIE_MAX 65536        // au-delà, la session n'est plus lue
+#define EVENEMENTS_MAX 256
+#define NIVEAUX_MAX 64
+#define ZOOM_MIN 1
+#define ZOOM_MAX 3
+
+/* Définition de type*/
+/**
+* @brief Une connexion et sa partie
+*/
+typedef struct {
+    int fd;
+    t_sokoban *partie;
+    int zoom;
+    uint32_t evenements;        // événements demandés à epoll
+    bool pause;                 // sortie pleine : les commandes attendent
+    bool perdue;                // mémoire manquante : la session sera fermée
+    size_t nbEntree;            // octets de la ligne en cours
+    char entree[SESSION_ENTREE];
+    char *sortie;               // réponses pas encore envoyées
+    size_t debutSortie;
+    size_t nbSortie;
+    size_t capaSortie;
+} t_session;
+
+/**
+* @brief État du serveur
+*/
+typedef struct {
+    int ecoute;                 // socket d'écoute
+    int epoll;
+    t_sokoban *niveaux[NIVEAUX_MAX];
+    int nbNiveaux;
+    t_session **sessions;       // indexées par descripteur
+    int capaSessions;
+    long ouvertes;
+    long maxOuvertes;
+    long commandes;
+} t_serveur;
+
+/* Définition de fonction*/
+void arreter(int signal);
+bool serveur_ouvrir(t_serveur *serveur, char chemin[]);
+void serveur_boucle(t_serveur *serveur);
+void serveur_accepter(t_serveur *serveur);
+void session_fermer(t_serveur *serveur, t_session *session);
+bool session_lire(t_serveur *serveur, t_session *session);
+void session_traiter(t_serveur *serveur, t_session *session);
+bool session_ecrire(t_serveur *serveur, t_session *session);
+void session_commande(t_serveur *serveur, t_session *session, char *ligne);
+void sortie_ajouter(t_session *session, const char *texte, size_t n);
+void sortie_printf(t_session *session, const char *format, ...);
+void afficher_bilan(t_serveur *serveur, double debut);
+
+static volatile sig_atomic_t arret = 0;
+
+
+/**
+* @brief Entrée du serveur
+* @return 0 : arrêt normal du programme, 1 en cas d'erreur
+* serveur_sokoban <socket> <niveau.sok> [niveau.sok ...]
+* Tourne jusqu'à SIGINT ou SIGTERM, puis affiche un bilan JSON : sessions
+* ouvertes au plus, commandes traitées et temps processeur consommé.
+*/
+int main(int argc, char *argv[]) {
+    t_serveur serveur;
+    struct sigaction action;
+    struct rlimit limite;
+    struct timespec t;
+    int erreur;
+
+    if ( argc < 3 ) {
+        fprintf(stderr, "usage : %s <socket> <niveau.sok> [niveau.sok ...]\n",
+            argv[0]);
+        return 1;
+    }
+    memset(&serveur, 0, sizeof(serveur));
+    for (int a = 2; a < argc && serveur.nbNiveaux < NIVEAUX_MAX; a++) {
+        serveur.niveaux[serveur.nbNiveaux] = sokoban_ouvrir(argv[a], &erreur);
+        if ( serveur.niveaux[serveur.nbNiveaux] == NULL ) {
+            fprintf(stderr, "niveau illisible : %s (%d)\n", argv[a], erreur);
+            return 1;
+        }
+        serveur.nbNiveaux++;
+    }
+    // une session par descripteur : autant de descripteurs que permis
+    if ( getrlimit(RLIMIT_NOFILE, &limite) == 0 ) {
+        limite.rlim_cur = limite.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limite);
+    }
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = arreter;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if ( !serveur_ouvrir(&serveur, argv[1]) ) {
+        perror(argv[1]);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    serveur_boucle(&serveur);
+    afficher_bilan(&serveur, (double)t.tv_sec + (double)t.tv_nsec * 1e-9);
+
+    for (int fd = 0; fd < serveur.capaSessions; fd++) {
+        if ( serveur.sessions[fd] != NULL ) {
+            session_fermer(&serveur, serveur.sessions[fd]);
+        }
+    }
+    free(serveur.sessions);
+    for (int k = 0; k < serveur.nbNiveaux; k++) {
+        sokoban_liberer(serveur.niveaux[k]);
+    }
+    close(serveur.epoll);
+    close(serveur.ecoute);
+    unlink(argv[1]);
+    return 0;
+}
+
+
+/**
+* @brief Gestionnaire de SIGINT et SIGTERM : la boucle s'arrête au retour
+* d'epoll_wait()
+* @param signal de type int : le signal reçu
+*/
+void arreter(int signal) {
+    (void)signal;
+    arret = 1;
+}
+
+
+/**
+* @brief Crée la socket d'écoute (l'ancienne est remplacée) et l'instance
+* epoll
+* @param serveur de type *t_serveur : le serveur
+* @param chemin de type char[] : le chemin de la socket
+* @return false en cas d'erreur (errno est renseigné)
+*/
+bool serveur_ouvrir(t_serveur *serveur, char chemin[]) {
+    struct sockaddr_un adresse;
+    struct epoll_event ev;
+
+    if ( strlen(chemin) >= sizeof(adresse.sun_path) ) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    memset(&adresse, 0, sizeof(adresse));
+    adresse.sun_family = AF_UNIX;
+    strcpy(adresse.sun_path, chemin);
+    unlink(chemin);
+    serveur->ecoute = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if ( serveur->ecoute < 0 ||
+        bind(serveur->ecoute, (struct sockaddr *)&adresse, sizeof(adresse)) != 0 ||
+        listen(serveur->ecoute, SOMAXCONN) != 0 ) {
+        return false;
+    }
+    serveur->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if ( serveur->epoll < 0 ) {
+        return false;
+    }
+    ev.events = EPOLLIN;
+    ev.data.fd = serveur->ecoute;
+    return epoll_ctl(serveur->epoll, EPOLL_CTL_ADD, serveur->ecoute, &ev) == 0;
+}
+
+
+/**
+* @brief Boucle d'événements : accepte les connexions, lit les commandes
+* et envoie les réponses jusqu'à l'arrêt du serveur
+* @param serveur de type *t_serveur : le serveur
+*/
+void serveur_boucle(t_serveur *serveur) {
+    struct epoll_event evenements[EVENEMENTS_MAX];
+
+    while ( !arret ) {
+        int nb = epoll_wait(serveur->epoll, evenements, EVENEMENTS_MAX, -1);
+        if ( nb < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            perror("epoll_wait");
+            return;
+        }
+        for (int k = 0; k < nb; k++) {
+            int fd = evenements[k].data.fd;
+            t_session *session;
+            bool ok;
+
+            if ( fd == serveur->ecoute ) {
+                serveur_accepter(serveur);
+                continue;
+            }
+            session = serveur->sessions[fd];
+            if ( session == NULL ) {
+                continue;
+            }
+            ok = !(evenements[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) ||
+                session_lire(serveur, session);
+            // une session qui vide sa sortie reprend les commandes reçues
+            while ( ok && (ok = session_ecrire(serveur, session)) &&
+                session->pause && session->nbSortie < SORTIE_MAX ) {
+                ok = session_lire(serveur, session);
+            }
+            if ( !ok ) {
+                session_fermer(serveur, session);
+            }
+        }
+    }
+}
+
+
+/**
+* @brief Accepte toutes les connexions en attente ; chacune commence une
+* partie sur le premier niveau
+* @param serveur de type *t_serveur : le serveur
+*/
+void serveur_accepter(t_serveur *serveur) {
+    struct epoll_event ev;
+    t_session *session;
+    int erreur;
+    int fd;
+
+    while ( (fd = accept4(serveur->ecoute, NULL, NULL,
+        SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0 ) {
+        if ( fd >= serveur->capaSessions ) {
+            int capa = (serveur->capaSessions == 0) ? 1024 : serveur->capaSessions;
+            t_session **sessions;
+            while ( capa <= fd ) {
+                capa *= 2;
+            }
+            sessions = realloc(serveur->sessions, (size_t)capa * sizeof(t_session *));
+            if ( sessions == NULL ) {
+                close(fd);
+                continue;
+            }
+            memset(sessions + serveur->capaSessions, 0,
+                (size_t)(capa - serveur->capaSessions) * sizeof(t_session *));
+            serveur->sessions = sessions;
+            serveur->capaSessions = capa;
+        }
+        session = calloc(1, sizeof(t_session));
+        if ( session == NULL ||
+            (session->partie = sokoban_cloner(serveur->niveaux[0], &erreur)) == NULL ) {
+            free(session);
+            close(fd);
+            continue;
+        }
+        session->fd = fd;
+        session->zoom = ZOOM_MIN;
+        session->evenements = EPOLLIN;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if ( epoll_ctl(serveur->epoll, EPOLL_CTL_ADD, fd, &ev) != 0 ) {
+            sokoban_liberer(session->partie);
+            free(session);
+            close(fd);
+            continue;
+        }
+        serveur->sessions[fd] = session;
+        serveur->ouvertes++;
+        if ( serveur->ouvertes > serveur->maxOuvertes ) {
+            serveur->maxOuvertes = serveur->ouvertes;
+        }
+    }
+}
+
+
+/**
+* @brief Ferme une connexion et libère sa partie
+* @param serveur de type *t_serveur : le serveur
+* @param session de type *t_session : la session
+*/
+void session_fermer(t_serveur *serveur, t_session *session) {
+    // close() retire aussi le descripteur de l'instance epoll
+    close(session->fd);
+    serveur->sessions[session->fd] = NULL;
+    serveur->ouvertes--;
+    sokoban_liberer(session->partie);
+    free(session->sortie);
+    free(session);
+}
+
+
+/**
+* @brief Lit ce qui est arrivé sur la connexion et traite chaque ligne
+* complète, jusqu'à ce que la socket soit vide ou que SORTIE_MAX octets
+* de réponses attendent (la session est alors en pause)
+* @param serveur de type *t_serveur : le serveur
+* @param session de type *t_session : la session
+* @return false si la connexion est fermée ou en erreur
+*/
+bool session_lire(t_serveur *serveur, t_session *session) {
+    session->pause = false;
+    for (;;) {
+        ssize_t lu;
+
+        session_traiter(serveur, session);
+        if ( session->perdue ) {
+            return false;
+        }
+        if ( session->nbSortie >= SORTIE_MAX ) {
+            session->pause = true;
+            return true;
+        }
+        if ( session->nbEntree == SESSION_ENTREE ) {
+            // une ligne plus longue que le tampon : elle est oubliée
+            sortie_printf(session, "erreur ligne trop longue\n");
+            session->nbEntree = 0;
+        }
+        lu = read(session->fd, session->entree + session->nbEntree,
+            SESSION_ENTREE - session->nbEntree);
+        if ( lu == 0 ) {
+            return false;
+        }
+        if ( lu < 0 ) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        session->nbEntree += (size_t)lu;
+    }
+}
+
+
+/**
+* @brief Exécute les lignes complètes déjà lues, tant que la sortie n'a
+* pas atteint SORTIE_MAX ; le reste attend dans le tampon d'entrée
+* @param serveur de type *t_serveur : le serveur
+* @param session de type *t_session : la session
+*/
+void session_traiter(t_serveur *serveur, t_session *session) {
+    size_t debut = 0;
+
+    for (size_t k = 0; k < session->nbEntree &&
+        session->nbSortie < SORTIE_MAX; k++) {
+        if ( session->entree[k] == '\n' ) {
+            session->entree[k] = '\0';
+            session_commande(serveur, session, session->entree + debut);
+            debut = k + 1;
+        }
+    }
+    memmove(session->entree, session->entree + debut, session->nbEntree - debut);
+    session->nbEntree -= debut;
+}
+
+
+/**
+* @brief Envoie les réponses en attente ; ce qui ne part pas attend
+* EPOLLOUT, et une session en pause n'attend plus EPOLLIN
+* @param serveur de type *t_serveur : le serveur
+* @param session de type *t_session : la session
+* @return false si la connexion est en erreur
+*/
+bool session_ecrire(t_serveur *serveur, t_session *session) {
+    struct epoll_event ev;
+    uint32_t evenements;
+
+    if ( session->perdue ) {
+        return false;
+    }
+    while ( session->nbSortie > 0 ) {
+        ssize_t ecrit = write(session->fd, session->sortie + session->debutSortie,
+            session->nbSortie);
+        if ( ecrit < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            if ( errno != EAGAIN && errno != EWOULDBLOCK ) {
+                return false;
+            }
+            break;
+        }
+        session->debutSortie += (size_t)ecrit;
+        session->nbSortie -= (size_t)ecrit;
+    }
+    if ( session->nbSortie == 0 ) {
+        session->debutSortie = 0;
+    }
+    evenements = (session->pause && session->nbSortie >= SORTIE_MAX) ? 0 : EPOLLIN;
+    if ( session->nbSortie > 0 ) {
+        evenements |= EPOLLOUT;
+    }
+    if ( evenements != session->evenements ) {
+        ev.events = evenements;
+        ev.data.fd = session->fd;
+        epoll_ctl(serveur->epoll, EPOLL_CTL_MOD, session->fd, &ev);
+        session->evenements = evenements;
+    }
+    return true;
+}
+
+
+/**
+* @brief Exécute une commande du protocole et range sa réponse
+* @param serveur de type *t_serveur : le serveur
+* @param session de type *t_session : la session
+* @param ligne de type char* : la commande, sans le '\n'
+*/
+void session_commande(t_serveur *serveur, t_session *session, char *ligne) {
+    t_sokoban *partie = session->partie;
+    int res = SOKOBAN_OK;
+    long k;
+
+    serveur->commandes++;
+    switch ( ligne[0] ) {
+        case 'z':
+            res = sokoban_jouer(partie, SOKOBAN_HAUT);
+            break;
+        case 's':
+            res = sokoban_jouer(partie, SOKOBAN_BAS);
+            break;
+        case 'q':
+            res = sokoban_jouer(partie, SOKOBAN_GAUCHE);
+            break;
+        case 'd':
+            res = sokoban_jouer(partie, SOKOBAN_DROITE);
+            break;
+        case 'u':
+            res = sokoban_annuler(partie);
+            break;
+        case 'y':
+            res = sokoban_refaire(partie);
+            break;
+        case 'r':
+            sokoban_recommencer(partie);
+            break;
+        case '+':
+        case '-':
+            session->zoom += (ligne[0] == '+') ? 1 : -1;
+            session->zoom = (session->zoom < ZOOM_MIN) ? ZOOM_MIN :
+                (session->zoom > ZOOM_MAX) ? ZOOM_MAX : session->zoom;
+            sortie_printf(session, "zoom %d\n", session->zoom);
+            return;
+        case 'e': {
+            int largeur = sokoban_largeur(partie);
+            int hauteur = sokoban_hauteur(partie);
+            sortie_printf(session, "etat %ld %d %d %d\n", sokoban_nb_coups(partie),
+                session->zoom, sokoban_gagne(partie), hauteur * session->zoom);
+            for (int i = 0; i < hauteur; i++) {
+                for (int z = 0; z < session->zoom; z++) {
+                    for (int j = 0; j < largeur; j++) {
+                        char c = sokoban_case(partie, i, j);
+                        for (int zj = 0; zj < session->zoom; zj++) {
+                            sortie_ajouter(session, &c, 1);
+                        }
+                    }
+                    sortie_ajouter(session, "\n", 1);
+                }
+            }
+            return;
+        }
+        case 'n':
+            k = strtol(ligne + 1, NULL, 10);
+            if ( k < 1 || k > serveur->nbNiveaux ) {
+                sortie_printf(session, "erreur niveau %ld inconnu\n", k);
+                return;
+            }
+            partie = sokoban_cloner(serveur->niveaux[k - 1], &res);
+            if ( partie == NULL ) {
+                break;
+            }
+            sokoban_liberer(session->partie);
+            session->partie = partie;
+            break;
+        default:
+            sortie_printf(session, "erreur commande inconnue\n");
+            return;
+    }
+    if ( res == SOKOBAN_ERREUR_MEMOIRE ) {
+        sortie_printf(session, "erreur memoire\n");
+    } else {
+        sortie_printf(session, "%s %ld\n", (res == SOKOBAN_BLOQUE) ? "bloque" :
+            sokoban_gagne(partie) ? "gagne" : "ok", sokoban_nb_coups(partie));
+    }
+}
+
+
+/**
+* @brief Ajoute des octets aux réponses en attente d'une session ; si la
+* mémoire manque, la session est marquée perdue et sera fermée
+* @param session de type *t_session : la session
+* @param texte de type char* : les octets
+* @param n de type size_t : leur nombre
+*/
+void sortie_ajouter(t_session *session, const char *texte, size_t n) {
+    size_t fin = session->debutSortie + session->nbSortie;
+
+    if ( session->perdue ) {
+        return;
+    }
+    if ( fin + n > session->capaSortie ) {
+        size_t capa = (session->capaSortie == 0) ? SORTIE_CAPACITE_INIT
+            : session->capaSortie;
+        char *sortie;
+        // la place des octets déjà envoyés est d'abord reprise
+        if ( session->debutSortie > 0 ) {
+            memmove(session->sortie, session->sortie + session->debutSortie,
+                session->nbSortie);
+            session->debutSortie = 0;
+        }
+        fin = session->nbSortie;
+        while ( capa < fin + n ) {
+            capa *= 2;
+        }
+        if ( capa > session->capaSortie ) {
+            sortie = realloc(session->sortie, capa);
+            if ( sortie == NULL ) {
+                session->perdue = true;
+                return;
+            }
+            session->sortie = sortie;
+            session->capaSortie = capa;
+        }
+    }
+    memcpy(session->sortie + fin, texte, n);
+    session->nbSortie += n;
+}
+
+
+/**
+* @brief Ajoute une réponse formatée comme printf()
+* @param session de type *t_session : la session
+* @param format de type char* : le format
+*/
+void sortie_printf(t_session *session, const char *format, ...) {
+    char ligne[128];
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vsnprintf(ligne, sizeof(ligne), format, args);
+    va_end(args);
+    if ( n > 0 ) {
+        sortie_ajouter(session, ligne,
+            ((size_t)n < sizeof(ligne)) ? (size_t)n : sizeof(ligne) - 1);
+    }
+}
+
+
+/**
+* @brief Affiche le bilan du serveur sur une ligne JSON
+* @param serveur de type *t_serveur : le serveur
+* @param debut de type double : l'heure de démarrage (horloge monotone)
+*/
+void afficher_bilan(t_serveur *serveur, double debut) {
+    struct rusage usage;
+    struct timespec t;
+    double cpu, duree;
+
+    getrusage(RUSAGE_SELF, &usage);
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    cpu = (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec * 1e-6
+        + (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec * 1e-6;
+    duree = (double)t.tv_sec + (double)t.tv_nsec * 1e-9 - debut;
+    printf("{\"serveur\":\"sokoban\",\"sessions_max\":%ld,\"commandes\":%ld,"
+        "\"duree_s\":%.2f,\"cpu_s\":%.2f,\"commandes_s_cpu\":%.0f,"
+        "\"memoire_max_ko\":%ld}\n",
+        serveur->maxOuvertes, serveur->commandes, duree, cpu,
+        (cpu > 0) ? (double)serveur->commandes / cpu : 0.0, usage.ru_maxrss);
+    fflush(stdout);
+}
@@ -0,0 +1,694 @@
+/**
+* @file sokoban.h
+* @brief Sokoban : constantes, types et fonctions du jeu
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* Partagé par le moteur (libsokoban.c), le jeu (jeu_sokoban.c) et les
+* bancs d'essai. Les programmes qui embarquent le moteur n'utilisent que
+* libsokoban.h.
+*
+*/
+
+#ifndef SOKOBAN_H
+#define SOKOBAN_H
+
+/* Fichiers inclus */
+#include <stdlib.h>
+#include <stdio.h>
+#include <termios.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "libsokoban.h"
+
+/* Définition de constante*/
+#define DEPL_BLOC 8192
+#define DEPL_BITS 3
+#define POINTS_INTERVALLE 256
+#define COUP_POUSSEE 4
+#define CASE_VIDE 0
+#define CASE_MUR 1
+#define CASE_CAISSE 2
+#define CASE_CIBLE 4
+#define CASE_JOUEUR 8
+#define CASE_MORTE 16
+#define CASE_BLOQUE (CASE_MUR | CASE_CAISSE)
+#define BENCH_COUPS 10000000L
+#define BB_BITS 64
+#define SOL_CASES_MAX 65535
+#define SOL_BLOC 4096
+#define SOL_INFINI UINT16_MAX
+#define SOL_NOUVEAU 0
+#define SOL_DEJA_VU 1
+#define SOL_PLEINE 2
+#define SOL_MEMOIRE_DEFAUT 256
+#define REJEU_RESOLU 0
+#define REJEU_NON_RESOLU 1
+#define REJEU_ILLEGAL 2
+#define REJEU_FICHIER 3
+#define REJEU_AUTRE_NIVEAU 4
+#define REJEU_SANS_JOUEUR 5
+#define JOURNAL_MAGIE "SOKJ"
+#define JOURNAL_VERSION 1
+#define JOURNAL_ENTETE 32
+#define JOURNAL_POS_NB 24
+#define JOURNAL_RLE 1
+#define JOURNAL_REPETITION_MAX 32
+#define JOURNAL_TAMPON 4096
+#define JOURNAL_FIN -1
+#define JOURNAL_ERREUR -2
+#define SAUVEGARDE_MAGIE "SOKS"
+#define SAUVEGARDE_VERSION 1
+#define SAUVEGARDE_ENTETE 40
+#define SAUVEGARDE_POS_SOMME 32
+#define SAUVEGARDE_CASES_MAX (1 << 28)  // cases d'un plateau, bordure comprise
+#define PACK_MAGIE "SOKI"
+#define PACK_VERSION 1
+#define PACK_ENTETE 32
+#define PACK_ENTREE 12
+#define PACK_SUFFIXE ".idx"
+#define INDEX_MAGIE "SOKX"
+#define INDEX_VERSION 1
+#define INDEX_ENTETE 24
+#define INDEX_ENTREE 16
+#define INDEX_CAPACITE_MIN 1024
+#define VIDE ' '
+#define SOKOBAN '@'
+#define CIBLE '.'
+#define SOKOBAN_CIBLE '+'
+#define CAISSE '$'
+#define CAISSE_CIBLE '*'
+#define MUR '#'
+#define HAUT 'z'
+#define BAS 's'
+#define DROITE 'd'
+#define GAUCHE 'q'
+#define ABANDON 'x'
+#define RECOMMENCE 'r'
+#define UNDO 'u'
+#define REFAIRE 'y'
+#define ALLER 'g'
+#define MARCHER 'c'
+#define BRANCHE 'b'
+#define ZOOM '+'
+#define DE_ZOOM '-'
+#define SAUVER 'e'
+#define SOKO_GAUCHE 'g'
+#define SOKO_DROITE 'd'
+#define SOKO_HAUT 'h'
+#define SOKO_BAS 'b'
+#define CAISSE_GAUCHE 'G'
+#define CAISSE_DROITE 'D'
+#define CAISSE_HAUT 'H'
+#define CAISSE_BAS 'B'
+#define ZOOM_MAX 3
+#define ZOOM_MIN 1
+#define DELAI_INFINI -1
+#define PAS_DE_TOUCHE -1
+#define FIN_ENTREE -2
+#define TRAME_CAPACITE_INIT 4096
+#define EFFACER_ECRAN "\033[H\033[2J"
+#define ENTETE_LIGNES 14
+#define LIGNE_COMPTEUR 13
+#define ALERTE_IMPASSE "IMPASSE : la partie ne peut plus être gagnée"
+#define ALERTE_INACCESSIBLE "case inaccessible"
+#define ALERTE_MEMOIRE "mémoire insuffisante"
+#define MODIFS_MAX 3
+#define REDIMENSION -3
+#define DEMANDE_MESURES -4
+#define MESURES 'm'
+#define MESURES_FICHIER "sokoban_mesures.txt"
+#define HISTO_SOUS_BITS 4
+#define HISTO_SOUS (1 << HISTO_SOUS_BITS)
+#define HISTO_CASES ((64 - HISTO_SOUS_BITS + 1) * HISTO_SOUS)
+#define BORDURE 1
+#define NB_DIRECTIONS 4
+#define DIR_HAUT 0
+#define DIR_BAS 1
+#define DIR_GAUCHE 2
+#define DIR_DROITE 3
+
+/* Définition de type*/
+/**
+* @brief Historique des déplacements, sans limite de taille
+* Chaque coup tient sur DEPL_BITS bits : la direction (DIR_*) sur les deux
+* bits de poids faible et COUP_POUSSEE si une caisse a été poussée.
+* Les coups sont rangés dans des blocs de DEPL_BLOC coups alloués au fur
+* et à mesure : un bloc plein n'est jamais recopié.
+* Les coups annulés restent rangés après nb, jusqu'à fin, pour être
+* refaits ; un nouveau coup les efface.
+*/
+typedef struct {
+    uint8_t **blocs;
+    int nbBlocs;        // blocs alloués
+    int capaBlocs;      // taille du tableau de blocs
+    long nb;            // nombre de coups joués
+    long fin;           // nombre de coups enregistrés, annulés compris
+} t_tab_deplacement;
+
+/**
+* @brief Plateau de jeu de taille quelconque
+* Les cases sont rangées ligne par ligne dans un seul tableau contigu.
+* Le plateau est entouré d'une bordure de murs (BORDURE case de chaque
+* côté), ce qui évite tout test de limite lors des déplacements :
+* la case (i, j) est à l'indice (i + BORDURE) * pas + (j + BORDURE).
+* Chaque case est une combinaison des bits CASE_MUR, CASE_CAISSE,
+* CASE_CIBLE et CASE_JOUEUR ; les caractères du format .sok ne sont
+* utilisés qu'au chargement, à l'enregistrement et à l'affichage.
+* CASE_MORTE marque les cases d'où une caisse ne peut plus atteindre
+* aucune cible (voir analyser_niveau()).
+*/
+typedef struct {
+    int largeur;                    // nombre de colonnes du niveau
+    int hauteur;                    // nombre de lignes du niveau
+    int pas;                        // longueur d'une ligne stockée
+    int voisin[NB_DIRECTIONS];      // décalage d'indice par direction
+    int cibles;                     // cibles non couvertes par une caisse
+    int mortes;                     // caisses sur une case morte
+    int figes;                      // carrés 2x2 figés hors cible
+    uint64_t empreinte;             // identité du niveau chargé
+    uint8_t *cases;
+} t_plateau;
+
+/**
+* @brief Seconde représentation d'un niveau, pour la simulation en masse
+* Murs, caisses et cibles sont chacun un ensemble de bits sur les cases
+* (mêmes indices que t_plateau, bordure comprise), rangé par mots de
+* 64 bits ; le joueur est un indice de case. La victoire se teste en
+* comparant les mots des caisses à ceux des cibles.
+*/
+typedef struct {
+    int largeur;
+    int hauteur;
+    int pas;
+    int voisin[NB_DIRECTIONS];
+    int nbMots;         // mots de 64 bits par ensemble
+    int joueur;
+    uint64_t *murs;
+    uint64_t *caisses;
+    uint64_t *cibles;
+} t_bitboard;
+
+/**
+* @brief Données d'un niveau préparées pour le solveur (lecture seule
+* pendant la recherche) ; les cases sont indicées comme dans t_plateau
+*/
+typedef struct {
+    int total;                  // nombre de cases, bordure comprise
+    int voisin[NB_DIRECTIONS];
+    int nbCaisses;
+    int ciblesLibres;           // au départ
+    int joueurDepart;
+    bool perdu;                 // le niveau est en impasse dès le départ
+    uint8_t *murs;
+    uint8_t *cibles;
+    uint16_t *distance;         // distance à la cible la plus proche
+    uint64_t *zCaisse;          // clés Zobrist d'une caisse par case
+    uint64_t *zJoueur;          // clés Zobrist de la zone du joueur par case
+    uint16_t *caissesDepart;
+} t_niveau_sol;
+
+/**
+* @brief Nœud de la recherche : un état atteint par une poussée.
+* Les positions des caisses sont rangées à part (voir t_arene).
+*/
+typedef struct {
+    int64_t parent;             // référence (fil << 32 | indice), -1 : racine
+    uint16_t joueur;            // case du joueur, ancienne case de la caisse
+    uint8_t dir;                // direction de la poussée
+    uint16_t g;                 // nombre de poussées depuis le départ
+    uint16_t h;                 // estimation des poussées restantes
+    uint16_t ciblesLibres;
+    uint64_t cleCaisses;        // clé Zobrist des seules caisses
+} t_noeud_sol;
+
+/**
+* @brief Table de transposition à adressage ouvert (0 = entrée libre)
+*/
+typedef struct {
+    uint64_t *cles;
+    size_t masque;
+    size_t occupes;
+} t_table_tt;
+
+/**
+* @brief Tableaux de travail réutilisés d'un parcours à l'autre
+*/
+typedef struct {
+    uint8_t *occupe;            // 1 si une caisse occupe la case
+    uint32_t *vu;               // marques des parcours (zone du père)
+    uint32_t *vuFils;           // marques des parcours (zones des fils)
+    uint16_t *file;
+    uint8_t *venu;              // direction d'arrivée dans la case
+    uint32_t generation;
+} t_travail_sol;
+
+/**
+* @brief Nœuds créés par un fil d'exécution, rangés par blocs de SOL_BLOC
+* nœuds qui ne sont jamais déplacés : le nœud k est blocs[k / SOL_BLOC]
+* [k % SOL_BLOC], ses caisses sont dans caisses[k / SOL_BLOC]
+* à partir de (k % SOL_BLOC) * nbCaisses
+*/
+typedef struct {
+    t_noeud_sol **blocs;
+    uint16_t **caisses;
+    int maxBlocs;
+    uint32_t nb;
+} t_arene;
+
+/**
+* @brief Pile de nœuds à développer d'un fil d'exécution : son propriétaire
+* travaille au bas (fin), les autres fils volent en haut (debut)
+*/
+typedef struct {
+    int64_t *refs;
+    size_t debut;
+    size_t fin;
+    size_t capa;
+    pthread_mutex_t verrou;
+} t_pile_sol;
+
+/**
+* @brief État engendré par une poussée, avant d'être rangé dans un nœud
+*/
+typedef struct {
+    uint16_t caisse;            // numéro de la caisse poussée
+    uint16_t dest;              // sa nouvelle case
+    uint8_t dir;
+    uint16_t h;
+    uint16_t ciblesLibres;
+    uint64_t cleCaisses;
+} t_fils_sol;
+
+struct s_solveur;
+
+/**
+* @brief Un fil d'exécution de la recherche
+*/
+typedef struct {
+    struct s_solveur *sol;
+    int num;
+    t_arene arene;
+    t_pile_sol pile;
+    t_travail_sol trav;
+    t_fils_sol *fils;
+    long developpes;
+} t_ouvrier;
+
+/**
+* @brief État d'une recherche de solution. La recherche A* n'utilise que
+* le premier fil et le tas ; la recherche parallèle utilise les piles.
+*/
+typedef struct s_solveur {
+    t_niveau_sol *niv;
+    t_table_tt tt;              // partagée, sans verrou
+    t_ouvrier *ouvriers;
+    int nbOuvriers;
+    uint64_t *tas;
+    size_t tailleTas;
+    size_t capaTas;
+    size_t memoire;             // octets alloués par la recherche
+    size_t memoireMax;
+    long enCours;               // nœuds empilés pas encore développés
+    int fini;                   // 1 : solution trouvée, 2 : mémoire épuisée
+    int64_t solution;
+} t_solveur;
+
+/**
+* @brief Points de contrôle d'une partie : une copie du plateau tous les
+* POINTS_INTERVALLE coups de l'historique, la première étant le niveau
+* de départ. Le point k correspond au coup k * POINTS_INTERVALLE.
+*/
+typedef struct {
+    int total;                  // cases par plateau, bordure comprise
+    long nb;                    // points valides
+    long capa;
+    uint8_t *cases;             // nb plateaux de total cases
+    int *etats;                 // par point : joueur, cibles, mortes, figes
+} t_points;
+
+/**
+* @brief Coup de l'arbre des parties : les variantes jouées depuis une même
+* position partagent le chemin qui y mène. Les fils d'un coup forment une
+* liste (au plus un par direction) dont le premier est la variante suivie.
+*/
+typedef struct {
+    int32_t premier;    // premier fils, -1 si aucun
+    int32_t frere;      // fils suivant du même parent, -1 si aucun
+    uint8_t coup;       // direction | COUP_POUSSEE (inutilisé pour la racine)
+} t_noeud_coup;
+
+/**
+* @brief Arbre des parties. La ligne suivie va de la racine (le niveau de
+* départ) en passant toujours par le premier fils ; elle correspond aux
+* coups 0 à fin de l'historique et ligne[k] est le coup atteint après k
+* coups, ce qui évite de parcourir l'arbre pour annuler ou refaire.
+*/
+typedef struct {
+    t_noeud_coup *noeuds;
+    int32_t nb;
+    int32_t capa;
+    int32_t *ligne;
+    long capaLigne;
+} t_arbre;
+
+/**
+* @brief Une partie : le contexte opaque de libsokoban.h
+*/
+struct s_sokoban {
+    t_plateau plat;
+    t_plateau depart;           // le niveau au début de la partie
+    int joueur;
+    int joueurDepart;
+    t_tab_deplacement depl;
+    t_points points;
+    t_arbre arbre;
+    uint32_t *vus;              // tampons de partie_marcher(), NULL avant
+    int32_t *file;              // le premier appel
+    uint8_t *venue;
+    uint32_t generation;
+};
+
+/**
+* @brief Index de clés de niveaux : le contexte opaque de libsokoban.h.
+* Table à adressage ouvert (sondage linéaire), projetée depuis un
+* fichier ou en mémoire anonyme : INDEX_ENTETE octets ("SOKX", version
+* sur 32 bits, capacité et nombre de clés sur 64 bits), puis une entrée
+* de INDEX_ENTREE octets par emplacement (les deux moitiés de la clé, en
+* petit-boutiste ; un emplacement libre vaut zéro).
+*/
+struct s_sokoban_index {
+    int fd;                     // -1 pour un index en mémoire
+    char *fichier;              // NULL pour un index en mémoire
+    uint8_t *carte;
+    size_t octets;              // taille de la projection
+    uint64_t capacite;          // emplacements, une puissance de 2
+    uint64_t nombre;            // clés
+};
+
+/**
+* @brief Cases modifiées par un déplacement ou une annulation
+* (ancienne case du joueur, nouvelle case, caisse poussée)
+*/
+typedef struct {
+    int n;
+    int pos[MODIFS_MAX];
+} t_modifs;
+
+/**
+* @brief Cases à réécrire à l'écran après une touche, en ligne et colonne
+* (même rôle que t_modifs, pour l'affichage qui ne voit que libsokoban.h)
+*/
+typedef struct {
+    int n;
+    int ligne[MODIFS_MAX];
+    int colonne[MODIFS_MAX];
+} t_cases_ecran;
+
+/**
+* @brief Tampon réutilisable dans lequel est construite une trame complète
+* avant d'être envoyée au terminal en un seul write(2)
+*/
+typedef struct {
+    char *donnees;
+    size_t taille;
+    size_t capacite;
+    long octetsTrame;   // octets envoyés pour la dernière trame
+    long appelsTrame;   // appels write(2) pour la dernière trame
+    long trames;
+    long octetsTotal;
+    long appelsTotal;
+} t_trame;
+
+#ifdef SOKOBAN_MESURES
+/**
+* @brief Histogramme de durées en nanosecondes à la manière de HdrHistogram :
+* les valeurs de 2^e à 2^(e+1) sont réparties en HISTO_SOUS cases égales,
+* soit une précision relative d'environ 1/HISTO_SOUS sur toute la plage,
+* avec un coût constant par valeur notée
+*/
+typedef struct {
+    uint64_t comptes[HISTO_CASES];
+    uint64_t nb;
+    uint64_t somme;
+    uint64_t max;
+} t_histo;
+
+/**
+* @brief Mesures de la boucle de jeu (compilée avec SOKOBAN_MESURES)
+*/
+typedef struct {
+    t_histo toucheTrame;    // touche lue -> trame envoyée
+    t_histo traitement;     // deplacer(), undo(), refaire
+    t_histo rendu;          // construction de la trame
+    long touches;
+    long polls;             // appels poll(2) de lire_touche()
+    long lectures;          // appels read(2) de lire_touche()
+} t_mesures;
+#endif
+
+/**
+* @brief Vérification d'une solution : un niveau, un fichier de coups
+* écrit par enregistrerDeplacements() et le résultat du rejeu
+*/
+typedef struct {
+    char *niveau;
+    char *coups;
+    int etat;           // REJEU_*
+    long nbCoups;       // coups joués (jusqu'au coup illégal exclu)
+    long poussees;
+    long illegal;       // numéro du premier coup illégal, à partir de 1
+    char codeIllegal;
+} t_rejeu;
+
+/**
+* @brief File de vérifications partagée par les fils d'exécution
+*/
+typedef struct {
+    t_rejeu *rejeux;
+    int nb;
+    int suivant;        // prochaine vérification à prendre
+} t_lot_rejeu;
+
+/**
+* @brief Journal de coups binaire, lu ou écrit au fil de l'eau avec un
+* tampon de taille fixe, quelle que soit la longueur de la partie.
+* Format (entiers en petit-boutiste) : JOURNAL_ENTETE octets d'entête,
+* "SOKJ", version (16 bits), options (16 bits, JOURNAL_RLE), empreinte
+* du niveau (64 bits), largeur et hauteur (32 bits chacune), nombre de
+* coups (64 bits) ; puis un octet par suite de coups identiques : le
+* coup (DEPL_BITS bits) dans les bits de poids faible, la longueur moins
+* un au-dessus (au plus JOURNAL_REPETITION_MAX coups). JOURNAL_RLE est la
+* seule option connue ; un journal sans elle est refusé.
+*/
+typedef struct {
+    FILE *f;
+    bool ecriture;
+    int options;
+    uint64_t empreinte;
+    uint32_t largeur;
+    uint32_t hauteur;
+    uint64_t nbCoups;           // coups écrits, ou annoncés par l'entête
+    uint64_t lus;               // coups déjà rendus par journal_lire()
+    int courant;                // coup en attente, -1 si aucun
+    int repetition;             // longueur de la suite en attente
+    size_t taille;              // octets utiles du tampon
+    size_t pos;                 // prochain octet à lire
+    uint8_t tampon[JOURNAL_TAMPON];
+} t_journal;
+
+/**
+* @brief Recueil de niveaux (.xsb, .txt) projeté en mémoire, avec son index.
+* Un niveau est une suite de lignes de plateau (des murs et les
+* caractères du format .sok) ; titres, commentaires et lignes vides les
+* séparent. L'index, enregistré à côté d'un recueil de plusieurs niveaux
+* (suffixe PACK_SUFFIXE), commence par PACK_ENTETE octets : "SOKI",
+* version (32 bits), taille et date de modification du recueil, nombre
+* de niveaux (64 bits chacun) ; puis une entrée de PACK_ENTREE octets par
+* niveau : position (64 bits) et longueur (32 bits) de son texte, en
+* petit-boutiste.
+*/
+typedef struct {
+    char *donnees;
+    size_t taille;
+    uint8_t *index;
+    size_t tailleIndex;
+    bool indexProjete;          // index projeté, sinon alloué
+    long nbNiveaux;
+} t_pack;
+
+/* Définition de fonction*/
+void affichage_fin(bool win, bool surrend, t_sokoban *partie);
+void def_zoom(int *zoom, int coef);
+void enregistrer_plateau(t_sokoban *partie);
+void enregistrer_deplacement(t_sokoban *partie);
+void afficher_entete(t_trame *trame, char nom[20], long count, bool impasse);
+void afficher_plateau(t_trame *trame, t_sokoban *partie, int zoom);
+void afficher_compteur(t_trame *trame, long count, bool impasse);
+void afficher_message(t_trame *trame, long count, bool impasse,
+    const char message[]);
+void afficher_cases(t_trame *trame, t_sokoban *partie, int zoom,
+    t_cases_ecran *modifs);
+void placer_curseur(t_trame *trame, t_sokoban *partie, int zoom);
+void trame_init(t_trame *trame);
+void trame_liberer(t_trame *trame);
+void trame_commencer(t_trame *trame);
+void trame_effacer(t_trame *trame);
+void trame_ajouter(t_trame *trame, const char *texte, size_t n);
+void trame_repeter(t_trame *trame, char c, size_t n);
+void trame_printf(t_trame *trame, const char *format, ...);
+void trame_envoyer(t_trame *trame);
+void trame_afficher_stats(t_trame *trame);
+int plateau_indice(t_plateau *plat, int i, int j);
+bool plateau_init(t_plateau *plat, int largeur, int hauteur);
+void plateau_liberer(t_plateau *plat);
+bool plateau_copier(t_plateau *dest, t_plateau *src);
+void cherche_joueur(t_plateau *plat, int *joueur);
+uint8_t car_vers_case(char c);
+char case_vers_car(uint8_t c);
+bool depl_case(t_plateau *plat, int caisse, int decalage);
+void mettre_a_jour_plateau(t_plateau *plat, int joueur, int suivant);
+bool deter_direct_code(char direct, int *dir);
+int jouer_coup(t_plateau *plat, int *joueur, int dir);
+void annuler_coup(t_plateau *plat, int *joueur, int coup);
+void depl_init(t_tab_deplacement *depl);
+void depl_liberer(t_tab_deplacement *depl);
+void depl_vider(t_tab_deplacement *depl);
+bool depl_reserver(t_tab_deplacement *depl, long k);
+bool depl_ajouter(t_tab_deplacement *depl, int coup);
+int depl_retirer(t_tab_deplacement *depl);
+int depl_refaire(t_tab_deplacement *depl);
+bool depl_prolonger(t_tab_deplacement *depl, int coup);
+bool depl_copier(t_tab_deplacement *dest, t_tab_deplacement *src);
+int depl_lire(t_tab_deplacement *depl, long k);
+char coup_vers_code(int coup);
+int code_vers_coup(char code);
+void deplacer(t_plateau *plat,t_tab_deplacement *depl, char direct, 
+    int *joueur, t_modifs *modifs);
+void undo(t_plateau *plat, t_tab_deplacement *depl, int *joueur,
+    t_modifs *modifs);
+void redo(t_plateau *plat, t_tab_deplacement *depl, int *joueur,
+    t_modifs *modifs);
+bool points_init(t_points *points, t_plateau *depart, int joueur);
+void points_liberer(t_points *points);
+bool points_copier(t_points *dest, t_points *src);
+bool points_noter(t_points *points, t_plateau *plat, int joueur, long nb);
+void points_tronquer(t_points *points, long coup);
+void points_reconstruire(t_points *points, t_plateau *plat, int *joueur,
+    t_tab_deplacement *depl);
+void aller_au_coup(t_plateau *plat, int *joueur, t_tab_deplacement *depl,
+    t_points *points, long n);
+bool arbre_init(t_arbre *arbre, t_tab_deplacement *depl);
+void arbre_liberer(t_arbre *arbre);
+bool arbre_copier(t_arbre *dest, t_arbre *src);
+bool arbre_reserver(t_arbre *arbre, long k, int32_t nouveaux);
+bool arbre_jouer(t_arbre *arbre, t_tab_deplacement *depl);
+int arbre_branches(t_arbre *arbre, t_tab_deplacement *depl, int coups[4],
+    long longueurs[4]);
+bool arbre_choisir(t_arbre *arbre, t_tab_deplacement *depl, int k);
+t_sokoban *partie_creer(t_plateau *plat, int *erreur);
+int partie_jouer(t_sokoban *partie, int dir, t_modifs *modifs);
+int partie_annuler(t_sokoban *partie, t_modifs *modifs);
+int partie_refaire(t_sokoban *partie, t_modifs *modifs);
+int partie_marcher(t_sokoban *partie, int cible, t_modifs *modifs);
+void jouer_touche(t_sokoban *partie, char touche, t_cases_ecran *modifs);
+int compter_cibles(t_plateau *plat);
+bool gagne(t_plateau *plat);
+bool analyser_niveau(t_plateau *plat);
+bool en_impasse(t_plateau *plat);
+void bitboard_depuis_plateau(t_bitboard *bb, t_plateau *plat, int joueur);
+void bitboard_vers_plateau(t_bitboard *bb, t_plateau *plat);
+void bitboard_liberer(t_bitboard *bb);
+int bitboard_jouer(t_bitboard *bb, int dir);
+void bitboard_annuler(t_bitboard *bb, int coup);
+bool bitboard_gagne(t_bitboard *bb);
+bool verif_recommencer();
+bool verif_abandonner();
+long demander_coup(long max);
+bool demander_case(t_sokoban *partie, int *ligne, int *colonne);
+int demander_branche(t_sokoban *partie);
+int longueur_utile(const char *ligne, size_t longueur);
+bool plateau_depuis_texte(t_plateau *plat, const char *texte, size_t taille);
+void verifier_memoire(bool ok);
+bool trouver_joueur(t_plateau *plat, int *joueur);
+int lire_niveau(t_plateau *plat, char fichier[], int *joueur);
+bool charger_partie(t_plateau *plat, char fichier[], int *joueur);
+void enregistrer_partie(t_plateau *plat, char fichier[]);
+void terminal_init();
+void terminal_restaurer();
+void terminal_suspendre();
+void terminal_reprendre();
+int lire_touche(int delaiMs);
+void enregistrerDeplacements(t_tab_deplacement *t, t_plateau *plat, char fic[]);
+bool enregistrer_coups(t_sokoban *partie, char fic[]);
+uint64_t empreinte_plateau(t_plateau *plat);
+void empreinte_128(const uint8_t *octets, size_t n, uint64_t h[2]);
+bool cle_canonique(t_plateau *plat, int joueur, uint64_t cle[2]);
+void ecrire_entier(uint8_t *p, uint64_t v, int octets);
+uint64_t lire_entier(const uint8_t *p, int octets);
+bool journal_creer(t_journal *j, char fic[], uint64_t empreinte, int largeur,
+    int hauteur);
+void journal_ecrire(t_journal *j, int coup);
+bool journal_ouvrir(t_journal *j, char fic[]);
+int journal_lire(t_journal *j);
+bool journal_fermer(t_journal *j);
+bool pack_ouvrir(t_pack *pack, char fichier[], bool *construit);
+bool pack_texte(t_pack *pack, long numero, const char **texte, size_t *taille);
+bool pack_niveau(t_pack *pack, long numero, t_plateau *plat);
+void pack_fermer(t_pack *pack);
+int infos_pack(char fichier[]);
+int dedoublonner(char index[], char *recueils[], int nb);
+char coup_vers_lurd(int coup);
+int lurd_vers_coup(char lurd);
+int exporter_lurd(char journal[], char sortie[]);
+bool sauver_partie(char fichier[], t_sokoban *partie);
+t_sokoban *ouvrir_partie(char fichier[]);
+int importer_lurd(char niveau[], char texte[], char journal[]);
+int bench_moteur(char fichier[], long coups);
+bool solveur_preparer(t_niveau_sol *niv, t_plateau *plat, int joueur);
+void solveur_liberer(t_niveau_sol *niv);
+int64_t solveur_chercher(t_solveur *sol);
+int64_t solveur_chercher_parallele(t_solveur *sol);
+long solveur_compter(t_solveur *sol, long *engendres);
+void solveur_terminer(t_solveur *sol);
+bool solveur_solution(t_solveur *sol, int64_t fin, t_plateau *plat, 
+    int joueur, t_tab_deplacement *depl);
+int resoudre(char fichier[], long memoireMo, char sortie[], int nbThreads);
+void rejouer(t_rejeu *rejeu);
+int verifier_solutions(char *fichiers[], int nb, int nbThreads);
+int partie_script(char niveau[], char script[], bool resume);
+
+/* Instrumentation : sans SOKOBAN_MESURES, les macros ne produisent aucun code */
+#ifdef SOKOBAN_MESURES
+uint64_t mesures_ns();
+void histo_noter(t_histo *histo, uint64_t valeur);
+uint64_t histo_quantile(t_histo *histo, double q);
+void mesures_fin(t_histo *histo, uint64_t *debut);
+bool mesures_ecrire(char fichier[], t_trame *trame, const char *raison);
+extern t_mesures mesures;
+#define MESURE_VARIABLE(t) uint64_t t = 0
+#define MESURE_TOP(t) ((t) = mesures_ns())
+#define MESURE_FIN(h, t) mesures_fin(&mesures.h, &(t))
+#define MESURE_COMPTER(c) (mesures.c++)
+#else
+#define MESURE_VARIABLE(t)
+#define MESURE_TOP(t) ((void)0)
+#define MESURE_FIN(h, t) ((void)0)
+#define MESURE_COMPTER(c) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,305 @@
+/**
+* @file test_libsokoban.c
+* @brief Test de bout en bout de libsokoban : jeu, sauvegarde, reprise
+* @author Jules Delapilliere
+* @version version 1.0
+* @date 09/11/2025
+*
+* N'utilise que libsokoban.h. Sur chaque niveau, joue des coups tirés au
+* hasard (avec des annulations) en notant l'empreinte de chaque position
+* de la ligne jouée, puis vérifie que la sauvegarde reprise et un clone
+* redonnent les mêmes empreintes en annulant puis en refaisant tout
+* l'historique. Vérifie aussi qu'une sauvegarde tronquée, altérée, dont
+* le plateau ne suit pas l'historique ou dont les dimensions sont nulles
+* ou démesurées est refusée. Chaque échec est affiché ; le programme rend
+* 1 s'il y en a un.
+*
+*/
+
+/* Fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libsokoban.h"
+
+/* Définition de constante*/
+#define COUPS_TEST 3000
+#define ENTETE_SAUVEGARDE 40    // voir sokoban_serialiser()
+#define POS_SOMME 32
+#define FICHIER_TEST "/tmp/test_libsokoban.sav"
+
+/* Définition de fonction*/
+uint32_t hasard(uint32_t *etat);
+bool verifier(bool condition, const char niveau[], const char quoi[]);
+bool tester_ligne(t_sokoban *partie, const uint64_t empreintes[], long n,
+    const char niveau[], const char quoi[]);
+bool tester_refus(const uint8_t *donnees, size_t taille, const char niveau[],
+    const char quoi[]);
+void resigner(uint8_t *donnees, size_t taille);
+bool tester_niveau(const char niveau[], uint32_t graine);
+
+
+/**
+* @brief Entrée du test
+* @return 0 si tout est vérifié, 1 sinon
+* test_libsokoban [niveau.sok ...]
+* Sans niveau, teste niveau1.sok à niveau6.sok.
+*/
+int main(int argc, char *argv[]) {
+    static char noms[6][24];
+    int reussis = 0, total = 0;
+
+    for (int k = 0; k < 6 && argc < 2; k++) {
+        snprintf(noms[k], sizeof(noms[k]), "niveau%d.sok", k + 1);
+        reussis += tester_niveau(noms[k], (uint32_t)k + 1);
+        total++;
+    }
+    for (int a = 1; a < argc; a++) {
+        reussis += tester_niveau(argv[a], (uint32_t)a);
+        total++;
+    }
+    remove(FICHIER_TEST);
+    printf("%d/%d niveaux vérifiés\n", reussis, total);
+    return (reussis == total) ? 0 : 1;
+}
+
+
+/**
+* @brief Tire un nombre au hasard (xorshift)
+* @param etat de type *uint32_t : l'état du générateur, non nul
+* @return le nombre tiré
+*/
+uint32_t hasard(uint32_t *etat) {
+    *etat ^= *etat << 13;
+    *etat ^= *etat >> 17;
+    *etat ^= *etat << 5;
+    return *etat;
+}
+
+
+/**
+* @brief Affiche un échec si la condition est fausse
+* @param condition de type bool : ce qui doit être vrai
+* @param niveau de type char[] : le niveau testé
+* @param quoi de type char[] : ce qui est vérifié
+* @return la condition
+*/
+bool verifier(bool condition, const char niveau[], const char quoi[]) {
+    if ( !condition ) {
+        printf("%s : échec, %s\n", niveau, quoi);
+    }
+    return condition;
+}
+
+
+/**
+* @brief Annule tout l'historique d'une partie puis le refait, en
+* comparant chaque position à l'empreinte notée pendant le jeu ; les
+* coups annulés enregistrés après le coup n (un clone les garde, une
+* sauvegarde non) restent à refaire
+* @param partie de type *t_sokoban : la partie, au coup n
+* @param empreintes de type uint64_t[] : l'empreinte des positions 0 à n
+* @param n de type long : le nombre de coups joués
+* @param niveau de type char[] : le niveau testé
+* @param quoi de type char[] : la partie testée (reprise, clone...)
+* @return true si toutes les positions correspondent
+*/
+bool tester_ligne(t_sokoban *partie, const uint64_t empreintes[], long n,
+    const char niveau[], const char quoi[]) {
+    long fin = sokoban_nb_enregistres(partie);
+    char message[128];
+
+    snprintf(message, sizeof(message), "%s : position ou historique", quoi);
+    if ( !verifier(sokoban_nb_coups(partie) == n &&
+        sokoban_empreinte(partie) == empreintes[n], niveau, message) ) {
+        return false;
+    }
+    for (long k = n; k > 0; k--) {
+        snprintf(message, sizeof(message), "%s : annulation du coup %ld",
+            quoi, k);
+        if ( !verifier(sokoban_annuler(partie) >= 0 &&
+            sokoban_empreinte(partie) == empreintes[k - 1], niveau, message) ) {
+            return false;
+        }
+    }
+    snprintf(message, sizeof(message), "%s : annulation au coup 0", quoi);
+    if ( !verifier(sokoban_annuler(partie) == SOKOBAN_BLOQUE, niveau,
+        message) ) {
+        return false;
+    }
+    for (long k = 1; k <= n; k++) {
+        snprintf(message, sizeof(message), "%s : coup %ld refait", quoi, k);
+        if ( !verifier(sokoban_refaire(partie) >= 0 &&
+            sokoban_empreinte(partie) == empreintes[k], niveau, message) ) {
+            return false;
+        }
+    }
+    snprintf(message, sizeof(message), "%s : coups à refaire après le coup %ld",
+        quoi, n);
+    return verifier((sokoban_refaire(partie) >= 0) == (fin > n), niveau, message);
+}
+
+
+/**
+* @brief Vérifie qu'une sauvegarde est refusée, en mémoire et en fichier
+* (un fichier qui ne commence pas par "SOKS" serait lu comme un niveau)
+* @param donnees de type *uint8_t : la sauvegarde
+* @param taille de type size_t : sa taille
+* @param niveau de type char[] : le niveau testé
+* @param quoi de type char[] : ce qui ne va pas dans la sauvegarde
+* @return true si la sauvegarde est refusée les deux fois
+*/
+bool tester_refus(const uint8_t *donnees, size_t taille, const char niveau[],
+    const char quoi[]) {
+    t_sokoban *partie;
+    FILE *f;
+    int erreur;
+    bool ok;
+
+    partie = sokoban_restaurer(donnees, taille, &erreur);
+    ok = partie == NULL && erreur == SOKOBAN_INVALIDE;
+    sokoban_liberer(partie);
+    if ( taille < 4 ) {
+        return verifier(ok, niveau, quoi);
+    }
+    f = fopen(FICHIER_TEST, "wb");
+    if ( f == NULL || fwrite(donnees, 1, taille, f) != taille ) {
+        if ( f != NULL ) {
+            fclose(f);
+        }
+        return verifier(false, niveau, "écriture de " FICHIER_TEST);
+    }
+    fclose(f);
+    partie = sokoban_ouvrir(FICHIER_TEST, &erreur);
+    ok = ok && partie == NULL;
+    sokoban_liberer(partie);
+    return verifier(ok, niveau, quoi);
+}
+
+
+/**
+* @brief Recalcule la somme de contrôle d'une sauvegarde modifiée (FNV-1a,
+* le champ de la somme compté à zéro)
+* @param donnees de type *uint8_t : la sauvegarde
+* @param taille de type size_t : sa taille
+*/
+void resigner(uint8_t *donnees, size_t taille) {
+    uint64_t h = 0xCBF29CE484222325ull;
+
+    for (size_t k = 0; k < taille; k++) {
+        bool champ = k >= POS_SOMME && k < POS_SOMME + 8;
+        h = (h ^ (champ ? 0 : donnees[k])) * 0x100000001B3ull;
+    }
+    for (int k = 0; k < 8; k++) {
+        donnees[POS_SOMME + k] = (uint8_t)(h >> (8 * k));
+    }
+}
+
+
+/**
+* @brief Teste un niveau : jeu au hasard, sauvegarde et reprise, clone,
+* annulations, puis sauvegardes tronquées et altérées
+* @param niveau de type char[] : le fichier du niveau
+* @param graine de type uint32_t : la graine du tirage des coups
+* @return true si tout est vérifié
+*/
+bool tester_niveau(const char niveau[], uint32_t graine) {
+    static uint64_t empreintes[COUPS_TEST + 1];
+    t_sokoban *partie, *reprise, *clone;
+    uint8_t *sauvegarde, *copie;
+    size_t taille;
+    int erreur;
+    bool ok = true;
+    long n;
+
+    partie = sokoban_ouvrir(niveau, &erreur);
+    if ( partie == NULL ) {
+        printf("%s : niveau illisible (%d)\n", niveau, erreur);
+        return false;
+    }
+
+    // jeu au hasard, une annulation sur huit tirages
+    empreintes[0] = sokoban_empreinte(partie);
+    for (int k = 0; k < COUPS_TEST; k++) {
+        uint32_t tirage = hasard(&graine);
+        if ( tirage % 8 == 0 ) {
+            sokoban_annuler(partie);
+        } else if ( sokoban_jouer(partie, (int)(tirage % 4)) >= 0 ) {
+            empreintes[sokoban_nb_coups(partie)] = sokoban_empreinte(partie);
+        }
+    }
+    n = sokoban_nb_coups(partie);
+
+    // sauvegarde, reprise et clone
+    taille = sokoban_serialiser(partie, NULL, 0);
+    sauvegarde = malloc(taille);
+    copie = malloc(taille);
+    if ( sauvegarde == NULL || copie == NULL ) {
+        printf("ERREUR MEMOIRE");
+        exit(EXIT_FAILURE);
+    }
+    ok = verifier(sokoban_serialiser(partie, sauvegarde, taille) == taille,
+        niveau, "taille de la sauvegarde") && ok;
+    reprise = sokoban_restaurer(sauvegarde, taille, &erreur);
+    clone = sokoban_cloner(partie, &erreur);
+    if ( !verifier(reprise != NULL && clone != NULL, niveau,
+        "reprise ou clone refusé") ) {
+        ok = false;
+    } else {
+        ok = tester_ligne(reprise, empreintes, n, niveau, "reprise") && ok;
+        ok = tester_ligne(clone, empreintes, n, niveau, "clone") && ok;
+        ok = verifier(sokoban_empreinte(partie) == empreintes[n], niveau,
+            "l'original a bougé avec son clone") && ok;
+    }
+    sokoban_liberer(reprise);
+    sokoban_liberer(clone);
+
+    // sauvegardes tronquées
+    size_t longueurs[] = { 0, 3, ENTETE_SAUVEGARDE - 1, ENTETE_SAUVEGARDE,
+        taille / 2, taille - 1 };
+    for (size_t k = 0; k < sizeof(longueurs) / sizeof(longueurs[0]); k++) {
+        if ( longueurs[k] < taille ) {
+            ok = tester_refus(sauvegarde, longueurs[k], niveau,
+                "sauvegarde tronquée acceptée") && ok;
+        }
+    }
+
+    // un octet altéré, de l'entête à l'historique
+    for (size_t k = 8; k < taille; k += 1 + taille / 16) {
+        memcpy(copie, sauvegarde, taille);
+        copie[k] ^= 0x40;
+        ok = tester_refus(copie, taille, niveau,
+            "sauvegarde altérée acceptée") && ok;
+    }
+
+    // historique incohérent avec le plateau, somme de contrôle recalculée
+    if ( n > 0 ) {
+        memcpy(copie, sauvegarde, taille);
+        copie[taille - 1] ^= (n % 2) ? 0x01 : 0x10;
+        resigner(copie, taille);
+        ok = tester_refus(copie, taille, niveau,
+            "historique incohérent accepté") && ok;
+    }
+
+    // largeur ou hauteur nulle ou démesurée, somme de contrôle recalculée
+    uint32_t dimensions[][2] = { { 0, 1 }, { 1, 0 }, { 0x7FFFFFFF, 0x7FFFFFFF },
+        { 0xFFFFFFFF, 1 }, { 1 << 16, 1 << 16 } };
+    for (size_t k = 0; k < sizeof(dimensions) / sizeof(dimensions[0]); k++) {
+        memcpy(copie, sauvegarde, taille);
+        for (int o = 0; o < 4; o++) {
+            copie[8 + o] = (uint8_t)(dimensions[k][0] >> (8 * o));
+            copie[12 + o] = (uint8_t)(dimensions[k][1] >> (8 * o));
+        }
+        resigner(copie, taille);
+        ok = tester_refus(copie, taille, niveau,
+            "dimensions hors limites acceptées") && ok;
+    }
+
+    free(sauvegarde);
+    free(copie);
+    sokoban_liberer(partie);
+    if ( ok ) {
+        printf("%s : ok, %ld coups rejoués\n", niveau, n);
+    }
+    return ok;
+}